@@ -1,11 +1,28 @@
+#include "CostModel.hpp"
+#include "IncrementalIndex.hpp"
 #include "LTLtranslator.hpp"
+#include "LtlFormula.hpp"
+#include "Manifest.hpp"
+#include "MemoryStats.hpp"
+#include "NetFile.hpp"
+#include "NetLoader.hpp"
+#include "OutputCache.hpp"
+#include "Pipeline.hpp"
+#include "TaskScheduler.hpp"
+#include "Trace.hpp"
 #include <CLI11.hpp>
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <iostream>
 #include <json.hpp>
-#include <regex>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -34,6 +51,8 @@
  * @return deserialized json object
  */
 nlohmann::json parse_json_file(const std::string &filename) {
+  LTL2PROP_TRACE_SCOPE(__func__, "load", filename);
+  LTL2PROP_MEMORY_PHASE(JsonDom);
   std::string content;
   std::string new_line;
   std::ifstream file_stream(filename);
@@ -52,6 +71,7 @@ nlohmann::json parse_json_file(const std::string &filename) {
  * @param content string to the be saved
  */
 void save_content(const std::string &filename, const std::string &content) {
+      LTL2PROP_TRACE_SCOPE(__func__, "write", filename);
 
       std::ofstream output_file(filename);
       output_file << content;
@@ -59,6 +79,7 @@ void save_content(const std::string &filename, const std::string &content) {
 }
 
 void removeLastOccurrenceFromFile(const std::string& filename, char charToRemove) {
+    LTL2PROP_TRACE_SCOPE(__func__, "write", filename);
     std::ifstream inFile(filename);
     if (!inFile) {
         std::cerr << "Error: Could not open the file for reading!" << std::endl;
@@ -89,6 +110,7 @@ void removeLastOccurrenceFromFile(const std::string& filename, char charToRemove
  * @param content string to the be saved
  */
 void append_content(const std::string& filename, const std::string& content) {
+    LTL2PROP_TRACE_SCOPE(__func__, "write", filename);
     std::ofstream outFile;
 
     // Open file in append mode
@@ -110,49 +132,844 @@ void append_content(const std::string& filename, const std::string& content) {
     }
 }
 
+/**
+ * Write a framed output to a stream
+ *
+ * A frame is a header line giving its kind, its name and the length in bytes
+ * of its content, followed by the content itself:
+ * \code
+ * #property <name> <length>
+ * <content>
+ * #propositions <name> <length>
+ * <content>
+ * \endcode
+ * so a reader can split the stream without parsing the Helena code. The
+ * propositions of a property are named after it; a batch shares a single
+ * propositions frame, named after its net.
+ *
+ * @param stream output stream (stdout or a named pipe)
+ * @param header kind and name of the frame
+ * @param content content of the frame
+ */
+void write_frame(std::ostream& stream, const std::string& header, const std::string& content) {
+  LTL2PROP_TRACE_SCOPE(__func__, "write", header);
+  stream << '#' << header << ' ' << content.size() << '\n';
+  stream.write(content.data(), content.size());
+}
+
+/**
+ * Report the verdict of a property decided without exploring the net
+ *
+ * @param output_name name of the outputs of the property
+ * @param verdict Holds or Violated
+ * @param stream true to write a frame "verdict <name>" holding "holds" or
+ * "violated" to stdout, false to print it as a line
+ */
+void report_verdict(const std::string& output_name, LTL2PROP::Verdict verdict, bool stream) {
+  bool holds = verdict == LTL2PROP::Verdict::Holds;
+  if (stream) {
+    write_frame(std::cout, "verdict " + output_name, holds ? "holds" : "violated");
+  } else {
+    std::cout << output_name << (holds ? " holds" : " is violated") << std::endl;
+  }
+}
+
+/**
+ * Name the output of a formula generated by an audit sweep
+ *
+ * @param formula LTL formula returned by LTLTranslator::sweep()
+ * @return <contract>.<function>.<vulnerability>[.<variable>]
+ */
+std::string sweep_output_name(const nlohmann::json& formula) {
+  static const std::map<std::string, std::string> short_names = {
+    {"Reentrancy", "reentrancy"},
+    {"Timestamp Dependance", "timestamp"},
+    {"Skip Empty String Literal", "skipempty"},
+    {"Self Destruction", "selfdestruction"},
+    {"Uninitialized Storage Variable", "usv"},
+  };
+  const nlohmann::json& inputs = formula.at("params").at("inputs");
+  std::string name = inputs.at("smart_contract").get<std::string>() + "." +
+                     inputs.at("selected_function").get<std::string>() + "." +
+                     short_names.at(formula.at("params").at("name"));
+  if (formula.at("params").at("name") == "Uninitialized Storage Variable") {
+    name += "." + inputs.at("selected_variable").get<std::string>();
+  }
+  return name;
+}
+
+/**
+ * Name the outputs of an input file of a batch or of a fan-out
+ *
+ * @param filename path to the LTL file or to the lna-info
+ * @return name of the file, without its directories and its extension
+ */
+std::string output_stem(const std::string& filename) {
+  std::string name = filename.substr(filename.find_last_of('/') + 1);
+  std::size_t extension = name.find_last_of('.');
+  return extension == 0 || extension == std::string::npos ? name : name.substr(0, extension);
+}
+
+/**
+ * @brief Property of a batch or of a sweep, through the pipeline stages
+ */
+struct BatchItem {
+  std::string output_name;
+  // LTL file of the formula, empty for formulas of a sweep
+  std::string ltl_file;
+  nlohmann::json formula;
+  // property and propositions, with the cost report and the manifest if asked for
+  std::map<std::string, std::string> ltl_result;
+  // key of the outputs in --cache-dir, empty without a cache
+  std::string cache_key;
+  // true when the outputs were found in --cache-dir
+  bool cached = false;
+  // hash of the formula and parts of the net read by its translation, for --incremental
+  std::string formula_hash;
+  std::set<std::string> dependencies;
+  // true when the outputs of a previous run are still up to date
+  bool up_to_date = false;
+  // verdict of an up to date property decided by a previous run
+  LTL2PROP::Verdict verdict = LTL2PROP::Verdict::Undecided;
+  std::string error;
+};
+
+/**
+ * @brief Net of a fan-out, through the pipeline stages
+ */
+struct FanOutItem {
+  std::string lna_info;
+  // content of the lna-info, released once parsed
+  std::string content;
+  // property and propositions, with the cost report and the manifest if asked for
+  std::map<std::string, std::string> ltl_result;
+  // key of the outputs in --cache-dir, empty without a cache
+  std::string cache_key;
+  // true when the outputs were found in --cache-dir
+  bool cached = false;
+  // digests of the net and parts of it read by the translation, for --incremental
+  std::map<std::string, std::string> net_digests;
+  std::set<std::string> dependencies;
+  // true when the outputs of a previous run are still up to date
+  bool up_to_date = false;
+  // verdict of an up to date property decided by a previous run
+  LTL2PROP::Verdict verdict = LTL2PROP::Verdict::Undecided;
+  std::string error;
+};
+
 int main(int argc, char **argv) {
   CLI::App app{"LTLTranslator tool"};
 
-  std::string LTL_FILE_PATH;
-  app.add_option("--ltl", LTL_FILE_PATH,
-                 "LTL file (.json), Vulnerabilities to check")
-      ->required()
-      ->check(CLI::ExistingFile);
-
-  std::string LNA_JSON_FILE_PATH;
-  app.add_option("--lna-info", LNA_JSON_FILE_PATH,
-                 "JSON file (.json), output of solidity2cpn tool")
+  std::vector<std::string> LTL_FILE_PATHS;
+  CLI::Option* ltl_option =
+      app.add_option("--ltl", LTL_FILE_PATHS,
+                     "LTL file (.json), Vulnerabilities to check. Several files "
+                     "are translated as a batch, the outputs are named after "
+                     "the file")
+          ->check(CLI::ExistingFile);
+
+  bool SWEEP = false;
+  app.add_flag("--sweep", SWEEP,
+               "Check every vulnerability on every function of the net, "
+               "instead of the --ltl formula")
+      ->excludes(ltl_option);
+
+  std::vector<std::string> LNA_JSON_FILE_PATHS;
+  app.add_option("--lna-info", LNA_JSON_FILE_PATHS,
+                 "JSON file (.json), output of solidity2cpn tool, or manifest "
+                 "of a sharded lna-info. With several files, the --ltl formula "
+                 "is translated against each net (fan-out) and the outputs "
+                 "are named after the file")
       ->required()
       ->check(CLI::ExistingFile);
 
   std::string OUT_FILE_PATH;
   app.add_option("--output-path", OUT_FILE_PATH, "Output file path")
       ->default_val("./")
-      ->check(CLI::ExistingDirectory);
+      ->check(CLI::ExistingDirectory | CLI::IsMember({"-"}));
 
   std::string OUT_FILE_NAME;
   app.add_option("--output-name", OUT_FILE_NAME, "Output file name")
       ->default_val("output");
 
+  bool SELECTIVE_LOAD = false;
+  app.add_flag("--selective-load", SELECTIVE_LOAD,
+               "Only load the statements of the contracts and functions "
+               "referenced by the LTL formula");
+
+  std::string INDEX_FILE_PATH;
+  app.add_option("--incremental", INDEX_FILE_PATH,
+                 "Index file (.json) of previous translations, the property is "
+                 "only generated again if the net parts it depends on or its "
+                 "output files changed");
+
+  std::string JSON_BACKEND;
+  app.add_option("--json-backend", JSON_BACKEND,
+                 "Parser reading the lna-info: dom builds a JSON document, "
+                 "sax reads the statements as they are parsed")
+      ->default_val(LTL2PROP::json_backend_name(LTL2PROP::default_json_backend()))
+      ->check(CLI::IsMember({"dom", "sax"}));
+
+  bool STREAM_OUTPUT = false;
+  app.add_flag("--stdout", STREAM_OUTPUT,
+               "Stream the properties and the propositions to stdout in "
+               "framed blocks instead of writing files (same as --output-path -)")
+      ->excludes("--incremental");
+
+  std::string BASE_NET_FILE_PATH;
+  app.add_option("--base-net", BASE_NET_FILE_PATH,
+                 "HCPN net (.lna) copied for each property and patched with "
+                 "its propositions, instead of patching <name>_HCPN.lna in place")
+      ->check(CLI::ExistingFile)
+      ->excludes("--stdout");
+
+  bool COST_REPORT = false;
+  app.add_flag("--cost-report", COST_REPORT,
+               "Write the estimated evaluation cost of each property to "
+               "<name>.cost.json");
+
+  bool MANIFEST = false;
+  app.add_flag("--manifest", MANIFEST,
+               "Write the class, the propositions, their places and the "
+               "statements they model of each property to <name>.manifest.json");
+
+  LTL2PROP::CostModel cost_model;
+  app.add_option("--token-bound", cost_model.token_bound,
+                 "Tokens assumed in a place other than S by the cost report")
+      ->default_val("8");
+
+  std::string CACHE_DIR;
+  app.add_option("--cache-dir", CACHE_DIR,
+                 "Directory of previous outputs, indexed by a hash of the "
+                 "lna-info, of the formula and of --token-bound; a formula "
+                 "found in it is written without loading the net")
+      ->check(CLI::ExistingDirectory)
+      ->excludes("--sweep")
+      ->excludes("--incremental");
+
+  bool STATIC_VERDICT = false;
+  app.add_flag("--static-verdict", STATIC_VERDICT,
+               "Decide the properties that are true or false once their "
+               "constant propositions are simplified instead of writing them: "
+               "their net is not patched, the verdict is printed (or streamed "
+               "in a verdict frame) and a single property exits with 2 if it "
+               "holds, 3 if it is violated");
+
+  unsigned JOBS = 0;
+  app.add_option("--jobs", JOBS,
+                 "Worker threads translating a batch, a sweep or a fan-out, "
+                 "which holds at most twice as many nets in memory (default: "
+                 "number of hardware threads)");
+
+#ifdef LTL2PROP_ENABLE_TRACING
+  std::string TRACE_FILE_PATH;
+  app.add_option("--trace", TRACE_FILE_PATH,
+                 "Trace file (.json) recording the time spent in each phase, "
+                 "in Chrome trace-event format");
+#endif
+
   CLI11_PARSE(app, argc, argv);
 
+#ifdef LTL2PROP_ENABLE_TRACING
+  // the trace is written when main returns
+  std::unique_ptr<LTL2PROP::TraceSession> trace_session;
+  if (!TRACE_FILE_PATH.empty()) {
+    trace_session.reset(new LTL2PROP::TraceSession(TRACE_FILE_PATH));
+  }
+#endif
+
+  if (OUT_FILE_PATH == "-") {
+    if (!INDEX_FILE_PATH.empty()) {
+      return app.exit(CLI::ExcludesError("--output-path -", "--incremental"));
+    }
+    if (!BASE_NET_FILE_PATH.empty()) {
+      return app.exit(CLI::ExcludesError("--output-path -", "--base-net"));
+    }
+    STREAM_OUTPUT = true;
+  }
+
+  LTL2PROP::JsonBackend json_backend = LTL2PROP::json_backend_from_name(JSON_BACKEND);
+
+  if (!SWEEP && LTL_FILE_PATHS.empty()) {
+    return app.exit(CLI::RequiredError("--ltl"));
+  }
+  bool BATCH = SWEEP || LTL_FILE_PATHS.size() > 1;
+  unsigned jobs = JOBS > 0 ? JOBS : std::max(1u, std::thread::hardware_concurrency());
+
   // full output path
   std::string full_outpath = OUT_FILE_PATH + OUT_FILE_NAME;
 
+  std::string LNA_JSON_FILE_PATH = LNA_JSON_FILE_PATHS.front();
+  bool FAN_OUT = LNA_JSON_FILE_PATHS.size() > 1;
+  if (BATCH && SELECTIVE_LOAD) {
+    return app.exit(CLI::ExcludesError("--selective-load", SWEEP ? "--sweep" : "several --ltl"));
+  }
+  if (FAN_OUT) {
+    if (SWEEP) return app.exit(CLI::ExcludesError("--sweep", "several --lna-info"));
+    if (BATCH) return app.exit(CLI::ExcludesError("several --ltl", "several --lna-info"));
+    if (!BASE_NET_FILE_PATH.empty()) return app.exit(CLI::ExcludesError("--base-net", "several --lna-info"));
+  }
+
   /****************************************************************************
    * READ FILES
    ****************************************************************************/
 
-  nlohmann::json ltl_json = parse_json_file(LTL_FILE_PATH);
-  nlohmann::json sol_json = parse_json_file(LNA_JSON_FILE_PATH);
+  std::unique_ptr<LTL2PROP::OutputCache> output_cache;
+  if (!CACHE_DIR.empty()) {
+    output_cache.reset(new LTL2PROP::OutputCache(CACHE_DIR));
+  }
+  std::string cache_options = "token_bound=" + std::to_string(cost_model.token_bound);
+
+  // look up a translation in the cache, its entry must hold every output asked for
+  auto find_outputs = [&](const std::string& key, std::map<std::string, std::string>& outputs) {
+    std::map<std::string, std::string> cached_outputs;
+    if (!output_cache->lookup(key, cached_outputs)) return false;
+    if ((COST_REPORT && cached_outputs.count("cost") == 0) ||
+        (MANIFEST && cached_outputs.count("manifest") == 0)) {
+      return false;
+    }
+    outputs.swap(cached_outputs);
+    return true;
+  };
+
+  // add the cost report and the manifest asked for to the outputs of a translation
+  auto add_reports = [&](std::map<std::string, std::string>& outputs, const LTL2PROP::CostModel& model,
+                         const LTL2PROP::PlaceIndex* place_index) {
+    if (COST_REPORT) outputs["cost"] = LTL2PROP::cost_report(outputs, model).dump(2);
+    if (MANIFEST) outputs["manifest"] = LTL2PROP::translation_manifest(outputs, *place_index);
+  };
+
+  // with --static-verdict, a property decided by its constant propositions
+  // is reported instead of being checked by Helena
+  auto decide = [&](const std::map<std::string, std::string>& outputs) {
+    if (!STATIC_VERDICT) return LTL2PROP::Verdict::Undecided;
+    return LTL2PROP::static_verdict(outputs.at("property"), outputs.at("propositions"));
+  };
+
+  // with --incremental, a property is only generated again if its formula, the
+  // parts of the net it read or the files it was written to changed; the index
+  // is shared by the stages of a batch or a fan-out
+  std::unique_ptr<LTL2PROP::IncrementalIndex> index;
+  std::mutex index_mutex;
+  std::string base_net_hash;
+  if (!INDEX_FILE_PATH.empty()) {
+    index.reset(new LTL2PROP::IncrementalIndex(INDEX_FILE_PATH));
+    if (!BASE_NET_FILE_PATH.empty()) base_net_hash = LTL2PROP::file_hash(BASE_NET_FILE_PATH);
+  }
+
+  // files checked by --incremental: the outputs of a property, the net patched
+  // with its propositions unless a batch shares it, and --base-net; a decided
+  // property has neither a property file nor a net
+  auto property_files = [&](const std::string& output_name, bool own_net, bool decided) {
+    std::vector<std::string> filenames;
+    if (!decided) filenames.push_back(OUT_FILE_PATH + output_name + ".prop.lna");
+    if (COST_REPORT) filenames.push_back(OUT_FILE_PATH + output_name + ".cost.json");
+    if (MANIFEST) filenames.push_back(OUT_FILE_PATH + output_name + ".manifest.json");
+    if (own_net && !decided) filenames.push_back(OUT_FILE_PATH + output_name + "_HCPN.lna");
+    std::map<std::string, std::string> files;
+    for (const auto& filename : filenames) {
+      files[filename] = LTL2PROP::file_hash(filename);
+    }
+    if (!BASE_NET_FILE_PATH.empty() && !decided) files[BASE_NET_FILE_PATH] = base_net_hash;
+    return files;
+  };
+
+  // verdict a previous run recorded for a property, only reused with --static-verdict
+  auto recorded_verdict = [&](const std::string& output_name) {
+    if (!STATIC_VERDICT) return LTL2PROP::Verdict::Undecided;
+    return index->verdict(OUT_FILE_PATH + output_name);
+  };
 
-  LTL2PROP::LTLTranslator ltl_translator = LTL2PROP::LTLTranslator(sol_json, ltl_json);
+  /****************************************************************************
+   * BATCH AND AUDIT SWEEP
+   ****************************************************************************/
+
+  // every property is saved in <name>.<formula>.prop.lna, <formula> being
+  // <contract>.<function>.<vulnerability> in a sweep and the name of the LTL
+  // file in a batch, and their propositions are added once to
+  // <name>_HCPN.lna, or to their own copy <name>.<formula>_HCPN.lna of --base-net
+  if (BATCH) {
+    std::vector<BatchItem> items;
+    std::set<std::string> formula_names;
+    for (const auto& ltl_file : LTL_FILE_PATHS) {
+      if (!formula_names.insert(output_stem(ltl_file)).second) {
+        std::cerr << "Error: several LTL files are named " << output_stem(ltl_file) << std::endl;
+        return 1;
+      }
+      BatchItem item;
+      item.output_name = OUT_FILE_NAME + "." + output_stem(ltl_file);
+      item.ltl_file = ltl_file;
+      items.push_back(std::move(item));
+    }
 
-  std::map<std::string, std::string> ltl_result = ltl_translator.translate();
-  save_content(full_outpath + ".prop.lna", ltl_result["property"]);
+    // with a cache, the formulas are read first and the net is only loaded
+    // if one of them is missing from the cache
+    bool load = true;
+    if (output_cache) {
+      std::string net_hash = LTL2PROP::net_file_hash(LNA_JSON_FILE_PATH);
+      load = false;
+      for (auto& item : items) {
+        try {
+          item.formula = parse_json_file(item.ltl_file);
+        }
+        catch (const std::exception& e) {
+          item.error = e.what();
+          continue;
+        }
+        item.cache_key = LTL2PROP::OutputCache::key(net_hash, item.formula, cache_options);
+        item.cached = find_outputs(item.cache_key, item.ltl_result);
+        if (!item.cached) load = true;
+      }
+    }
 
-  removeLastOccurrenceFromFile(full_outpath + "_HCPN.lna", '}');
-  append_content(full_outpath + "_HCPN.lna", ltl_result["propositions"]);
+    LTL2PROP::Net net;
+    if (load) net = LTL2PROP::load_net(LNA_JSON_FILE_PATH, LTL2PROP::NetScope(), json_backend);
+    cost_model.place_bounds.insert(net.place_capacities.begin(), net.place_capacities.end());
+    LTL2PROP::LTLTranslator ltl_translator(net, nlohmann::json::object());
+    std::unique_ptr<LTL2PROP::PlaceIndex> place_index;
+    if (MANIFEST) place_index.reset(new LTL2PROP::PlaceIndex(net));
+
+    if (SWEEP) {
+      for (const auto& formula : ltl_translator.sweep()) {
+        BatchItem item;
+        item.output_name = OUT_FILE_NAME + "." + sweep_output_name(formula);
+        item.formula = formula;
+        items.push_back(std::move(item));
+      }
+    }
+
+    // with --incremental, the properties of a batch are checked against the
+    // same digests; the net shared by a batch is checked once it is written
+    bool own_nets = !BASE_NET_FILE_PATH.empty();
+    std::map<std::string, std::string> net_digests;
+    std::string shared_net = full_outpath + "_HCPN.lna";
+    std::string shared_net_hash;
+    if (index) {
+      net_digests = LTL2PROP::net_digests(net);
+      if (!own_nets) shared_net_hash = LTL2PROP::file_hash(shared_net);
+    }
+    // true while the shared net holds the propositions of every property
+    bool net_up_to_date = true;
+    std::vector<std::string> indexed_names;
+
+    // LTL files are read, properties translated and outputs written at once;
+    // properties are stolen by idle workers, each worker translates with its
+    // own copy of the translator and the queries of a property are split
+    // among the workers left without properties
+    LTL2PROP::TaskScheduler scheduler(jobs);
+    std::vector<std::unique_ptr<LTL2PROP::LTLTranslator>> translators(scheduler.worker_count());
+    std::size_t next_item = 0;
+    bool failed = false;
+    std::string propositions;
+    std::set<std::string> declared_propositions;
+    auto add_propositions = [&](const std::string& item_propositions) {
+      std::istringstream proposition_lines(item_propositions);
+      std::string proposition;
+      while (std::getline(proposition_lines, proposition)) {
+        if (!proposition.empty() && declared_propositions.insert(proposition).second) {
+          propositions += proposition + "\n";
+        }
+      }
+    };
+
+    std::function<bool(BatchItem&)> read_formula = [&](BatchItem& item) {
+      if (next_item == items.size()) return false;
+      item = std::move(items[next_item++]);
+      if (!item.ltl_file.empty() && item.formula.is_null() && item.error.empty()) {
+        try {
+          item.formula = parse_json_file(item.ltl_file);
+        }
+        catch (const std::exception& e) {
+          item.error = e.what();
+        }
+      }
+      return true;
+    };
+
+    std::function<void(BatchItem&)> translate_formula = [&](BatchItem& item) {
+      if (!item.error.empty() || item.cached) return;
+      if (index) {
+        item.formula_hash = LTL2PROP::content_hash(item.formula.dump());
+        std::lock_guard<std::mutex> lock(index_mutex);
+        LTL2PROP::Verdict verdict = recorded_verdict(item.output_name);
+        std::map<std::string, std::string> files =
+            property_files(item.output_name, own_nets, verdict != LTL2PROP::Verdict::Undecided);
+        if (index->is_up_to_date(OUT_FILE_PATH + item.output_name, item.formula_hash, net_digests, files)) {
+          item.up_to_date = true;
+          item.verdict = verdict;
+          item.ltl_result["propositions"] = index->propositions(OUT_FILE_PATH + item.output_name);
+          return;
+        }
+      }
+      std::unique_ptr<LTL2PROP::LTLTranslator>& translator =
+          translators[LTL2PROP::TaskScheduler::current_worker()];
+      if (!translator) {
+        translator.reset(new LTL2PROP::LTLTranslator(ltl_translator));
+        translator->set_scheduler(&scheduler);
+      }
+      try {
+        item.ltl_result = translator->translate(item.formula);
+        add_reports(item.ltl_result, cost_model, place_index.get());
+        if (index) item.dependencies = translator->get_dependencies();
+      }
+      catch (const std::exception& e) {
+        item.error = e.what();
+      }
+    };
+
+    // outputs are written in the order of the formulas
+    std::function<void(BatchItem&)> write_property = [&](BatchItem& item) {
+      if (!item.error.empty()) {
+        std::cerr << "Error: " << (item.ltl_file.empty() ? item.output_name : item.ltl_file)
+                  << ": " << item.error << std::endl;
+        failed = true;
+        return;
+      }
+      std::map<std::string, std::string>& ltl_result = item.ltl_result;
+      const std::string& output_name = item.output_name;
+      if (item.up_to_date) {
+        std::cout << OUT_FILE_PATH + output_name << " is up to date" << std::endl;
+        // a decided property has no propositions in the shared net
+        if (item.verdict != LTL2PROP::Verdict::Undecided) {
+          report_verdict(OUT_FILE_PATH + output_name, item.verdict, false);
+          return;
+        }
+        if (own_nets) return;
+        std::lock_guard<std::mutex> lock(index_mutex);
+        net_up_to_date = net_up_to_date &&
+                         index->is_up_to_date(OUT_FILE_PATH + output_name, item.formula_hash, net_digests,
+                                              {{shared_net, shared_net_hash}});
+        indexed_names.push_back(output_name);
+        add_propositions(ltl_result["propositions"]);
+        return;
+      }
+      net_up_to_date = false;
+
+      // a translated property is recorded once its outputs are written, a
+      // decided property with its verdict and apart from the shared net
+      auto record = [&](LTL2PROP::Verdict verdict) {
+        if (!index) return;
+        bool decided = verdict != LTL2PROP::Verdict::Undecided;
+        std::map<std::string, std::string> files = property_files(output_name, own_nets, decided);
+        std::lock_guard<std::mutex> lock(index_mutex);
+        index->update(OUT_FILE_PATH + output_name, item.formula_hash, item.dependencies, net_digests,
+                      ltl_result["propositions"], files, verdict);
+        if (!decided) indexed_names.push_back(output_name);
+      };
+
+      if (output_cache && !item.cached) output_cache->store(item.cache_key, ltl_result);
+      LTL2PROP::Verdict verdict = decide(ltl_result);
+      if (verdict != LTL2PROP::Verdict::Undecided) {
+        report_verdict(STREAM_OUTPUT ? output_name : OUT_FILE_PATH + output_name, verdict, STREAM_OUTPUT);
+      } else if (STREAM_OUTPUT) {
+        write_frame(std::cout, "property " + output_name, ltl_result["property"]);
+      } else {
+        save_content(OUT_FILE_PATH + output_name + ".prop.lna", ltl_result["property"]);
+      }
+      if (COST_REPORT) {
+        if (STREAM_OUTPUT) write_frame(std::cout, "cost " + output_name, ltl_result["cost"]);
+        else save_content(OUT_FILE_PATH + output_name + ".cost.json", ltl_result["cost"]);
+      }
+      if (MANIFEST) {
+        if (STREAM_OUTPUT) write_frame(std::cout, "manifest " + output_name, ltl_result["manifest"]);
+        else save_content(OUT_FILE_PATH + output_name + ".manifest.json", ltl_result["manifest"]);
+      }
+      if (verdict != LTL2PROP::Verdict::Undecided) {
+        record(verdict);
+        return;
+      }
+
+      // each property gets its own copy of the net
+      if (own_nets) {
+        LTL2PROP::clone_file(BASE_NET_FILE_PATH, OUT_FILE_PATH + output_name + "_HCPN.lna");
+        LTL2PROP::append_propositions(OUT_FILE_PATH + output_name + "_HCPN.lna",
+                                      ltl_result["propositions"]);
+      } else {
+        add_propositions(ltl_result["propositions"]);
+      }
+      record(verdict);
+    };
+
+    LTL2PROP::run_pipeline(scheduler, 2 * scheduler.worker_count(), read_formula, translate_formula,
+                           write_property, true);
+
+    if (STREAM_OUTPUT) {
+      write_frame(std::cout, "propositions " + OUT_FILE_NAME, propositions);
+      std::cout.flush();
+      return failed ? 1 : 0;
+    }
+    if (own_nets) {
+      if (index) index->save();
+      return failed ? 1 : 0;
+    }
+
+    // a shared net still holding the propositions of every property is left untouched
+    if (index && net_up_to_date) {
+      index->save();
+      return failed ? 1 : 0;
+    }
+    removeLastOccurrenceFromFile(shared_net, '}');
+    append_content(shared_net, propositions);
+
+    if (index) {
+      std::string patched_net_hash = LTL2PROP::file_hash(shared_net);
+      for (const auto& output_name : indexed_names) {
+        std::map<std::string, std::string> files = property_files(output_name, false, false);
+        files[shared_net] = patched_net_hash;
+        index->update_files(OUT_FILE_PATH + output_name, files);
+      }
+      index->save();
+    }
+    return failed ? 1 : 0;
+  }
+
+  // the formula is read first, it tells which part of the net is needed
+  nlohmann::json ltl_json = parse_json_file(LTL_FILE_PATHS.front());
+  LTL2PROP::NetScope net_scope;
+  if (SELECTIVE_LOAD) {
+    net_scope = LTL2PROP::formula_scope(ltl_json);
+  }
+
+  /****************************************************************************
+   * FAN-OUT
+   ****************************************************************************/
+
+  // the property of each net is saved in <stem>.prop.lna and its propositions
+  // are added to <stem>_HCPN.lna, <stem> being the name of its lna-info file
+  if (FAN_OUT) {
+    std::set<std::string> output_names;
+    for (const auto& lna_info : LNA_JSON_FILE_PATHS) {
+      if (!output_names.insert(output_stem(lna_info)).second) {
+        std::cerr << "Error: several lna-info files are named " << output_stem(lna_info) << std::endl;
+        return 1;
+      }
+    }
+
+    // lna-info files are read, nets translated and outputs written at once;
+    // at most twice --jobs nets are in flight, the queries of the last nets
+    // are split among the workers left without nets
+    LTL2PROP::TaskScheduler scheduler(jobs);
+    std::size_t next_net = 0;
+    bool failed = false;
+    std::string formula_hash = index ? LTL2PROP::content_hash(ltl_json.dump()) : "";
+
+    std::function<bool(FanOutItem&)> read_net = [&](FanOutItem& item) {
+      if (next_net == LNA_JSON_FILE_PATHS.size()) return false;
+      item.lna_info = LNA_JSON_FILE_PATHS[next_net++];
+      try {
+        item.content = LTL2PROP::read_net_file(item.lna_info);
+      }
+      catch (const std::exception& e) {
+        item.error = e.what();
+      }
+      return true;
+    };
+
+    std::function<void(FanOutItem&)> translate_net = [&](FanOutItem& item) {
+      if (!item.error.empty()) return;
+      try {
+        // a net found in the cache is not parsed
+        if (output_cache) {
+          item.cache_key = LTL2PROP::OutputCache::key(LTL2PROP::net_content_hash(item.lna_info, item.content),
+                                                      ltl_json, cache_options);
+          item.cached = find_outputs(item.cache_key, item.ltl_result);
+          if (item.cached) {
+            std::string().swap(item.content);
+            return;
+          }
+        }
+
+        LTL2PROP::Net net = LTL2PROP::parse_net_file(item.lna_info, item.content, net_scope, json_backend);
+        std::string().swap(item.content);
+        if (index) {
+          std::string output_name = output_stem(item.lna_info);
+          item.net_digests = LTL2PROP::net_digests(net);
+          std::lock_guard<std::mutex> lock(index_mutex);
+          item.verdict = recorded_verdict(output_name);
+          std::map<std::string, std::string> files =
+              property_files(output_name, true, item.verdict != LTL2PROP::Verdict::Undecided);
+          item.up_to_date = index->is_up_to_date(OUT_FILE_PATH + output_name, formula_hash, item.net_digests, files);
+          if (item.up_to_date) return;
+          item.verdict = LTL2PROP::Verdict::Undecided;
+        }
+        LTL2PROP::CostModel net_cost_model = cost_model;
+        net_cost_model.place_bounds.insert(net.place_capacities.begin(), net.place_capacities.end());
+
+        LTL2PROP::LTLTranslator ltl_translator(net, ltl_json);
+        ltl_translator.set_scheduler(&scheduler);
+        item.ltl_result = ltl_translator.translate();
+        LTL2PROP::PlaceIndex place_index(net);
+        add_reports(item.ltl_result, net_cost_model, &place_index);
+        if (index) item.dependencies = ltl_translator.get_dependencies();
+      }
+      catch (const std::exception& e) {
+        item.error = e.what();
+      }
+    };
+
+    // nets are written as soon as they are translated
+    std::function<void(FanOutItem&)> write_net = [&](FanOutItem& item) {
+      if (!item.error.empty()) {
+        std::cerr << "Error: " << item.lna_info << ": " << item.error << std::endl;
+        failed = true;
+        return;
+      }
+      std::string output_name = output_stem(item.lna_info);
+      if (item.up_to_date) {
+        std::cout << OUT_FILE_PATH + output_name << " is up to date" << std::endl;
+        if (item.verdict != LTL2PROP::Verdict::Undecided) {
+          report_verdict(OUT_FILE_PATH + output_name, item.verdict, false);
+        }
+        return;
+      }
+      std::map<std::string, std::string>& ltl_result = item.ltl_result;
+      if (output_cache && !item.cached) output_cache->store(item.cache_key, ltl_result);
+      LTL2PROP::Verdict verdict = decide(ltl_result);
+
+      if (STREAM_OUTPUT) {
+        if (verdict != LTL2PROP::Verdict::Undecided) {
+          report_verdict(output_name, verdict, true);
+        } else {
+          write_frame(std::cout, "property " + output_name, ltl_result["property"]);
+          write_frame(std::cout, "propositions " + output_name, ltl_result["propositions"]);
+        }
+        if (COST_REPORT) write_frame(std::cout, "cost " + output_name, ltl_result["cost"]);
+        if (MANIFEST) write_frame(std::cout, "manifest " + output_name, ltl_result["manifest"]);
+        return;
+      }
+
+      if (COST_REPORT) {
+        save_content(OUT_FILE_PATH + output_name + ".cost.json", ltl_result["cost"]);
+      }
+      if (MANIFEST) {
+        save_content(OUT_FILE_PATH + output_name + ".manifest.json", ltl_result["manifest"]);
+      }
+      if (verdict != LTL2PROP::Verdict::Undecided) {
+        report_verdict(OUT_FILE_PATH + output_name, verdict, false);
+      } else {
+        save_content(OUT_FILE_PATH + output_name + ".prop.lna", ltl_result["property"]);
+        removeLastOccurrenceFromFile(OUT_FILE_PATH + output_name + "_HCPN.lna", '}');
+        append_content(OUT_FILE_PATH + output_name + "_HCPN.lna", ltl_result["propositions"]);
+      }
+
+      if (index) {
+        std::map<std::string, std::string> files =
+            property_files(output_name, true, verdict != LTL2PROP::Verdict::Undecided);
+        std::lock_guard<std::mutex> lock(index_mutex);
+        index->update(OUT_FILE_PATH + output_name, formula_hash, item.dependencies, item.net_digests,
+                      ltl_result["propositions"], files, verdict);
+      }
+    };
+
+    LTL2PROP::run_pipeline(scheduler, 2 * scheduler.worker_count(), read_net, translate_net,
+                           write_net, false);
+
+    if (STREAM_OUTPUT) std::cout.flush();
+    if (index) index->save();
+    return failed ? 1 : 0;
+  }
+
+  /****************************************************************************
+   * CACHED OUTPUTS
+   ****************************************************************************/
+
+  // a translation found in the cache is written without loading the net
+  std::map<std::string, std::string> ltl_result;
+  std::string cache_key;
+  bool cached = false;
+  if (output_cache) {
+    cache_key = LTL2PROP::OutputCache::key(LTL2PROP::net_file_hash(LNA_JSON_FILE_PATH), ltl_json,
+                                           cache_options);
+    cached = find_outputs(cache_key, ltl_result);
+  }
+
+  std::map<std::string, std::string> net_digests;
+  std::string formula_hash;
+  std::set<std::string> dependencies;
+  if (!cached) {
+    LTL2PROP::Net net = LTL2PROP::load_net(LNA_JSON_FILE_PATH, net_scope, json_backend);
+    cost_model.place_bounds.insert(net.place_capacities.begin(), net.place_capacities.end());
+
+    /**************************************************************************
+     * SKIP UNCHANGED PROPERTIES
+     **************************************************************************/
+
+    if (index) {
+      net_digests = LTL2PROP::net_digests(net);
+      formula_hash = LTL2PROP::content_hash(ltl_json.dump());
+
+      // outputs of an up to date property are left untouched, a decided
+      // property is reported again
+      LTL2PROP::Verdict verdict = recorded_verdict(OUT_FILE_NAME);
+      bool decided = verdict != LTL2PROP::Verdict::Undecided;
+      if (index->is_up_to_date(full_outpath, formula_hash, net_digests, property_files(OUT_FILE_NAME, true, decided))) {
+        std::cout << full_outpath << " is up to date" << std::endl;
+        if (!decided) return 0;
+        report_verdict(full_outpath, verdict, false);
+        return verdict == LTL2PROP::Verdict::Holds ? 2 : 3;
+      }
+    }
+
+    /**************************************************************************
+     * TRANSLATE
+     **************************************************************************/
+
+    LTL2PROP::LTLTranslator ltl_translator = LTL2PROP::LTLTranslator(net, ltl_json);
+
+    ltl_result = ltl_translator.translate();
+    std::unique_ptr<LTL2PROP::PlaceIndex> place_index;
+    if (MANIFEST) place_index.reset(new LTL2PROP::PlaceIndex(net));
+    add_reports(ltl_result, cost_model, place_index.get());
+    dependencies = ltl_translator.get_dependencies();
+
+    if (output_cache) output_cache->store(cache_key, ltl_result);
+  }
+
+  LTL2PROP::Verdict verdict = decide(ltl_result);
+  int verdict_status = verdict == LTL2PROP::Verdict::Holds      ? 2
+                       : verdict == LTL2PROP::Verdict::Violated ? 3
+                                                                : 0;
+
+  // the net patch is left to the reader of the stream
+  if (STREAM_OUTPUT) {
+    if (verdict != LTL2PROP::Verdict::Undecided) {
+      report_verdict(OUT_FILE_NAME, verdict, true);
+    } else {
+      write_frame(std::cout, "property " + OUT_FILE_NAME, ltl_result["property"]);
+      write_frame(std::cout, "propositions " + OUT_FILE_NAME, ltl_result["propositions"]);
+    }
+    if (COST_REPORT) write_frame(std::cout, "cost " + OUT_FILE_NAME, ltl_result["cost"]);
+    if (MANIFEST) write_frame(std::cout, "manifest " + OUT_FILE_NAME, ltl_result["manifest"]);
+    std::cout.flush();
+    return verdict_status;
+  }
+
+  if (COST_REPORT) {
+    save_content(full_outpath + ".cost.json", ltl_result["cost"]);
+  }
+  if (MANIFEST) {
+    save_content(full_outpath + ".manifest.json", ltl_result["manifest"]);
+  }
+
+  // a decided property is neither written nor added to the net
+  if (verdict != LTL2PROP::Verdict::Undecided) {
+    report_verdict(full_outpath, verdict, false);
+  } else {
+    save_content(full_outpath + ".prop.lna", ltl_result["property"]);
+    if (!BASE_NET_FILE_PATH.empty()) {
+      LTL2PROP::clone_file(BASE_NET_FILE_PATH, full_outpath + "_HCPN.lna");
+      LTL2PROP::append_propositions(full_outpath + "_HCPN.lna", ltl_result["propositions"]);
+    } else {
+      removeLastOccurrenceFromFile(full_outpath + "_HCPN.lna", '}');
+      append_content(full_outpath + "_HCPN.lna", ltl_result["propositions"]);
+    }
+  }
+
+  if (index) {
+    index->update(full_outpath, formula_hash, dependencies, net_digests, ltl_result["propositions"],
+                  property_files(OUT_FILE_NAME, true, verdict != LTL2PROP::Verdict::Undecided), verdict);
+    index->save();
+  }
 
-  return 0;
+  return verdict_status;
 }
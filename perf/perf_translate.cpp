@@ -0,0 +1,338 @@
+#include "LTLtranslator.hpp"
+#include "Net.hpp"
+#include "NetLoader.hpp"
+#include <CLI11.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <json.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// number of functions of the synthetic nets, each function has 10 statements
+const std::vector<std::size_t> net_sizes = {500, 1000, 2000, 4000, 8000};
+
+// functions per smart contract of the synthetic nets
+const std::size_t functions_per_contract = 100;
+
+// global variables of the synthetic nets
+const std::size_t global_variable_count = 16;
+
+/**
+ * Build a synthetic net
+ *
+ * Function f<i> of contract C<i / 100> declares a local from the balance,
+ * assigns it to a global, tests it, sends, calls the next function, loops on
+ * a global and returns with a timestamp.
+ *
+ * @param function_count number of functions
+ * @return net
+ */
+LTL2PROP::Net synthetic_net(std::size_t function_count) {
+  LTL2PROP::Net net;
+  for (std::size_t g = 0; g < global_variable_count; ++g) {
+    net.global_variables.push_back("g" + std::to_string(g));
+  }
+
+  for (std::size_t i = 0; i < function_count; ++i) {
+    std::string contract = "C" + std::to_string(i / functions_per_contract);
+    std::string function = "f" + std::to_string(i);
+    std::string callee = "f" + std::to_string((i + 1) % function_count);
+    std::string global = "g" + std::to_string(i % global_variable_count);
+    std::string prefix = contract + "_" + function + "_";
+    std::string local = "l" + std::to_string(i);
+
+    net.local_variables.push_back({contract, function, local, prefix + "locals"});
+    net.local_variables.push_back({contract, function, "s" + std::to_string(i), prefix + "locals"});
+
+    auto statement = [&](const std::string& type, const std::string& variable,
+                         const std::string& place, std::list<std::string> RHV, bool timestamp) {
+      net.statements.push_back({type, contract, function, variable, function, "", prefix + place,
+                                "", RHV, timestamp});
+    };
+    statement("variable_declaration", local, "decl", {"address(this).balance"}, false);
+    statement("assignment", global, "asg", {local}, false);
+    statement("selection", local, "sel", {}, false);
+    statement("require", "", "req", {local, global}, false);
+    statement("sending", "", "send", {local}, false);
+    statement("while_loop", local, "while", {global}, false);
+    statement("for_loop", local, "for", {"address(this).balance"}, false);
+    statement("assignment", "s" + std::to_string(i), "asg_ts", {"now"}, true);
+    statement("return", "", "ret", {global}, true);
+    net.statements.push_back({"function_call", contract, function, "", callee, prefix + "call_in",
+                              prefix + "call_out", prefix + "call_par", {}, false});
+  }
+  return net;
+}
+
+/**
+ * Serialize a net into lna-info JSON text
+ *
+ * @param net the net
+ * @return JSON text
+ */
+std::string lna_info(const LTL2PROP::Net& net) {
+  nlohmann::json lna_json = {
+    {"global_variables", nlohmann::json::array()},
+    {"functions", nlohmann::json::array()},
+    {"statements", nlohmann::json::array()},
+  };
+  for (const auto& global_variable : net.global_variables) {
+    lna_json["global_variables"].push_back({{"name", global_variable}});
+  }
+  for (const auto& local_variable : net.local_variables) {
+    lna_json["functions"].push_back({{"name", local_variable.function},
+                                     {"smart_contract", local_variable.smart_contract},
+                                     {"local_variables", {{{"name", local_variable.name},
+                                                           {"place", local_variable.place}}}}});
+  }
+  for (const auto& statement : net.statements) {
+    lna_json["statements"].push_back({
+      {"type", statement.type},
+      {"smart_contract", statement.smart_contract},
+      {"parent", statement.parent},
+      {"variable", statement.variable},
+      {"function", statement.function_name},
+      {"input_place", statement.input_place},
+      {"output_place", statement.output_place},
+      {"param_place", statement.param_place},
+      {"right_hand_variables", statement.RHV},
+      {"timestamp", statement.timestamp},
+    });
+  }
+  return lna_json.dump();
+}
+
+/**
+ * Build the LTL formula of a template test
+ *
+ * The calls of the synthetic nets form a ring, so the templates following
+ * the callees of f0 (reentrancy, timestamp) cover every function of the net.
+ *
+ * @param test name of the test
+ * @return LTL formula, null if the test is not a template
+ */
+nlohmann::json test_formula(const std::string& test) {
+  struct Formula {
+    std::string type;
+    std::string name;
+    nlohmann::json inputs;
+  };
+  static const nlohmann::json function_pair = {{"selected_function", "f0"}, {"smart_contract", "C0"},
+                                               {"rival_function", "f150"}, {"rival_contract", "C1"}};
+  static const std::map<std::string, Formula> formulas = {
+    {"reentrancy", {"general", "Reentrancy", {{"selected_variable", ""}, {"selected_function", "f0"},
+                                              {"smart_contract", "C0"}}}},
+    {"self_destruction", {"general", "Self Destruction", {{"selected_function", "f0"},
+                                                          {"smart_contract", "C0"},
+                                                          {"rival_contract", "C1"}}}},
+    {"timestamp", {"general", "Timestamp Dependance", {{"selected_function", "f0"},
+                                                       {"smart_contract", "C0"}}}},
+    {"skip_empty", {"general", "Skip Empty String Literal", {{"selected_function", "f0"},
+                                                             {"smart_contract", "C0"}}}},
+    {"usv", {"general", "Uninitialized Storage Variable", {{"selected_variable", "g0"},
+                                                           {"selected_function", "f0"},
+                                                           {"smart_contract", "C0"}}}},
+    {"integer_overflow", {"general", "Integer Overflow/Underflow", {{"selected_variable", "g0"},
+                                                                    {"min_threshold", "0"},
+                                                                    {"max_threshold", "100"}}}},
+    {"less_than", {"specific", "Variable Always Less Than", {{"selected_variable", "g0"},
+                                                             {"rival_variable", ""},
+                                                             {"max_threshold", "100"}}}},
+    {"bigger_than", {"specific", "Variable Always Bigger Than", {{"selected_variable", "g0"},
+                                                                 {"rival_variable", "g1"},
+                                                                 {"min_threshold", ""}}}},
+    {"equal_to", {"specific", "Variable Always Equal To", {{"selected_variable", "l0"},
+                                                           {"rival_variable", ""},
+                                                           {"constant", "0"},
+                                                           {"selected_function", "f0"},
+                                                           {"smart_contract", "C0"}}}},
+    {"eventually_called", {"specific", "Function Is Eventually Called", {{"selected_function", "f0"},
+                                                                         {"smart_contract", "C0"}}}},
+    {"never_called", {"specific", "Function Is Never Called", {{"selected_function", "f0"},
+                                                               {"smart_contract", "C0"}}}},
+    {"executed", {"specific", "Function Is Executed", {{"selected_function", "f0"},
+                                                       {"smart_contract", "C0"}}}},
+    {"sequential_call", {"specific", "Sequential Call", function_pair}},
+    {"sequential_execution", {"specific", "Sequential Execution", function_pair}},
+    {"call_then_execution", {"specific", "Function A Call Followed by Function B Execution", function_pair}},
+    {"execution_then_call", {"specific", "Function A Execution Followed by Function B Call", function_pair}},
+  };
+  auto formula = formulas.find(test);
+  if (formula == formulas.end()) return nullptr;
+  return {{"type", formula->second.type},
+          {"params", {{"name", formula->second.name}, {"inputs", formula->second.inputs}}}};
+}
+
+/**
+ * Time the fastest of several runs
+ *
+ * @param repetitions number of runs
+ * @param prepare called before each run, outside of the timing
+ * @param run the timed run
+ * @return duration of the fastest run in nanoseconds
+ */
+double fastest_run(int repetitions, const std::function<void()>& prepare,
+                   const std::function<void()>& run) {
+  double fastest = 0;
+  for (int repetition = 0; repetition < repetitions; ++repetition) {
+    prepare();
+    auto begin = std::chrono::steady_clock::now();
+    run();
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    if (repetition == 0 || elapsed < fastest) fastest = elapsed;
+  }
+  return fastest;
+}
+
+/**
+ * Fit t = a * n^k on a log-log scale
+ *
+ * @param sizes sizes n
+ * @param durations durations t
+ * @return exponent k
+ */
+double scaling_exponent(const std::vector<double>& sizes, const std::vector<double>& durations) {
+  double mean_x = 0, mean_y = 0;
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    mean_x += std::log(sizes[i]) / sizes.size();
+    mean_y += std::log(durations[i]) / sizes.size();
+  }
+  double covariance = 0, variance = 0;
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    covariance += (std::log(sizes[i]) - mean_x) * (std::log(durations[i]) - mean_y);
+    variance += (std::log(sizes[i]) - mean_x) * (std::log(sizes[i]) - mean_x);
+  }
+  return covariance / variance;
+}
+
+int main(int argc, char **argv) {
+  CLI::App app{"LTLTranslator performance regression test"};
+
+  std::string TEST;
+  app.add_option("--test", TEST,
+                 "Phase to be measured: load, index, a general template (reentrancy, "
+                 "self_destruction, timestamp, skip_empty, usv, integer_overflow) or a "
+                 "specific template (less_than, bigger_than, equal_to, eventually_called, "
+                 "never_called, executed, sequential_call, sequential_execution, "
+                 "call_then_execution, execution_then_call)")
+      ->required();
+
+  std::string BASELINE_FILE_PATH;
+  app.add_option("--baseline", BASELINE_FILE_PATH, "Baseline file (.json)")
+      ->required();
+
+  bool UPDATE_BASELINE = false;
+  app.add_flag("--update-baseline", UPDATE_BASELINE,
+               "Record the measures as the new baseline of the test");
+
+  std::string CONFIGURATION;
+  app.add_option("--configuration", CONFIGURATION,
+                 "Build type the baseline is recorded for")
+      ->default_val("default");
+
+  int REPETITIONS;
+  app.add_option("--repetitions", REPETITIONS, "Runs per net size, the fastest is kept")
+      ->default_val("5");
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (CONFIGURATION.empty()) CONFIGURATION = "default";
+
+  nlohmann::json formula = test_formula(TEST);
+  if (TEST != "load" && TEST != "index" && formula.is_null()) {
+    std::cerr << "Unknown test " << TEST << std::endl;
+    return 2;
+  }
+
+  nlohmann::json baseline = nlohmann::json::object();
+  {
+    std::ifstream baseline_stream(BASELINE_FILE_PATH);
+    if (baseline_stream) baseline = nlohmann::json::parse(baseline_stream);
+  }
+
+  // measure each net size
+  std::vector<double> sizes, durations;
+  for (std::size_t function_count : net_sizes) {
+    LTL2PROP::Net net = synthetic_net(function_count);
+    std::unique_ptr<LTL2PROP::LTLTranslator> translator;
+    double duration;
+
+    if (TEST == "load") {
+      std::string content = lna_info(net);
+      duration = fastest_run(REPETITIONS, [] {}, [&] { LTL2PROP::parse_net(content); });
+    }
+    else if (TEST == "index") {
+      duration = fastest_run(REPETITIONS, [] {}, [&] {
+        translator.reset(new LTL2PROP::LTLTranslator(net, nlohmann::json::object()));
+      });
+    }
+    else {
+      // a fresh translator for each run, so that no query result is cached
+      duration = fastest_run(REPETITIONS,
+                             [&] { translator.reset(new LTL2PROP::LTLTranslator(net, formula)); },
+                             [&] { translator->translate(); });
+    }
+
+    sizes.push_back(net.statements.size());
+    durations.push_back(duration);
+    std::cout << TEST << ": " << net.statements.size() << " statements, "
+              << duration / 1e3 << " us" << std::endl;
+  }
+
+  double exponent = scaling_exponent(sizes, durations);
+  double ns_per_statement = durations.back() / sizes.back();
+  std::cout << TEST << ": scaling exponent " << exponent << ", "
+            << ns_per_statement << " ns per statement" << std::endl;
+
+  if (UPDATE_BASELINE) {
+    baseline["tests"][CONFIGURATION][TEST] = {{"exponent", exponent}, {"ns_per_statement", ns_per_statement}};
+    std::ofstream baseline_stream(BASELINE_FILE_PATH);
+    baseline_stream << baseline.dump(2) << std::endl;
+    return 0;
+  }
+
+  // runs too short to be measured reliably always pass
+  double noise_floor_ns = baseline.value("noise_floor_us", 100.0) * 1e3;
+  if (durations.back() < noise_floor_ns) {
+    std::cout << TEST << ": below the noise floor, not checked" << std::endl;
+    return 0;
+  }
+
+  // runtimes must grow linearly with the net
+  double max_exponent = baseline.value("max_exponent", 1.5);
+  bool passed = true;
+  if (exponent > max_exponent) {
+    std::cout << TEST << ": FAILED, superlinear growth (exponent " << exponent
+              << " > " << max_exponent << ")" << std::endl;
+    passed = false;
+  }
+
+  // and stay close to the recorded baseline, the tolerance absorbs the
+  // difference between machines
+  double tolerance = baseline.value("tolerance", 3.0);
+  if (const char* tolerance_override = std::getenv("LTL2PROP_PERF_TOLERANCE")) {
+    tolerance = std::atof(tolerance_override);
+  }
+  nlohmann::json tests = baseline.value("tests", nlohmann::json::object())
+                            .value(CONFIGURATION, nlohmann::json::object());
+  auto test_baseline = tests.find(TEST);
+  if (test_baseline == tests.end()) {
+    std::cout << TEST << ": no baseline recorded for " << CONFIGURATION << " builds" << std::endl;
+  }
+  else {
+    double baseline_ns = test_baseline->at("ns_per_statement");
+    if (ns_per_statement > baseline_ns * tolerance) {
+      std::cout << TEST << ": FAILED, " << ns_per_statement << " ns per statement > "
+                << tolerance << " x baseline " << baseline_ns << std::endl;
+      passed = false;
+    }
+  }
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#ifndef COSTMODEL_HPP_
+#define COSTMODEL_HPP_
+
+#include <json.hpp>
+#include <map>
+#include <string>
+
+namespace LTL2PROP {
+
+/**
+ * @brief Token bounds of the places used to estimate evaluation costs
+ */
+struct CostModel {
+  // tokens assumed in a place whose bound is unknown
+  double token_bound = 8;
+
+  // known bounds, the state place S holds a single token
+  std::map<std::string, double> place_bounds = {{"S", 1}};
+
+  /**
+   * Get the number of tokens a place may hold
+   *
+   * @param place name of the place
+   * @return known bound of the place, token_bound otherwise
+   */
+  double bound(const std::string& place) const;
+};
+
+/**
+ * Estimate the cost of checking a translated property
+ *
+ * Each proposition is classified from its shape: a cardinality test
+ * (P'card > 0) costs one operation, a quantification
+ * (exists (t in P, t2 in Q | ...)) costs the product of the token bounds of
+ * its places times the comparisons of its condition. The per-state cost sums
+ * the propositions of the formula, which Helena evaluates in every visited
+ * state, and the formula's temporal operators bound the size of its automaton.
+ *
+ * @param translation property and propositions returned by LTLTranslator::translate
+ * @param model token bounds of the places
+ * @return cost report
+ */
+nlohmann::json cost_report(const std::map<std::string, std::string>& translation,
+                           const CostModel& model = CostModel());
+
+}  // namespace LTL2PROP
+
+#endif  // COSTMODEL_HPP_
@@ -0,0 +1,154 @@
+#ifndef INCREMENTALINDEX_HPP_
+#define INCREMENTALINDEX_HPP_
+
+#include <json.hpp>
+#include <map>
+#include <set>
+#include <string>
+#include "LtlFormula.hpp"
+#include "Net.hpp"
+
+namespace LTL2PROP {
+
+/**
+ * Hash a content with 64-bit FNV-1a
+ *
+ * @param content bytes to be hashed
+ * @return hexadecimal digest
+ */
+std::string content_hash(const std::string& content);
+
+/**
+ * Hash a range of bytes with 64-bit FNV-1a
+ *
+ * @param begin first byte
+ * @param end past the last byte
+ * @return hexadecimal digest, the same as content_hash() of the bytes as a string
+ */
+std::string content_hash(const char* begin, const char* end);
+
+/**
+ * Hash the content of a file with 64-bit FNV-1a
+ *
+ * @param filename path to the file
+ * @return hexadecimal digest, empty if the file cannot be read
+ */
+std::string file_hash(const std::string& filename);
+
+/**
+ * Compute the digests of the parts of a net a translation can depend on
+ *
+ * Digests are keyed like the dependencies reported by the translator:
+ * - "function:<contract>::<function>" for the statements whose parent or
+ *   function field is <function>,
+ * - "variable:<name>" for the statements defining or reading <name>,
+ * - "variables" for the global and local variables,
+ * - "calls" for the function calls and the entry points, which make the
+ *   call graph,
+ * - "definitions" for the functions defined by each smart contract, which
+ *   resolve the callees of the call graph,
+ * - "*" for the whole net.
+ *
+ * @param net the net
+ * @return digest of each part of the net
+ */
+std::map<std::string, std::string> net_digests(const Net& net);
+
+/**
+ * @brief Record of previously generated properties, of the parts of the net
+ * they were generated from and of the files they were written to
+ *
+ * A property only needs to be generated again when its formula changed, when
+ * it was generated by another translation_version, when the digest of one of
+ * its dependencies changed or when one of its output files was rewritten
+ * since, such as a net generated again without its propositions. A property
+ * decided by static_verdict() is recorded with its verdict and without the
+ * property and net files it never writes.
+ */
+class IncrementalIndex {
+ public:
+  /**
+   * Load an index file, an index that cannot be read is empty
+   *
+   * @param filename path to the index file
+   */
+  explicit IncrementalIndex(const std::string& filename);
+
+  /**
+   * Check if a property is still up to date with a net
+   *
+   * @param name output name of the property
+   * @param formula_hash hash of the LTL formula of the property
+   * @param digests digests of the current net
+   * @param files current hash of each file to be checked, see file_hash();
+   * a missing file is never up to date
+   * @return true if the property doesn't need to be generated again
+   */
+  bool is_up_to_date(const std::string& name, const std::string& formula_hash,
+                     const std::map<std::string, std::string>& digests,
+                     const std::map<std::string, std::string>& files) const;
+
+  /**
+   * Get the propositions recorded with a property
+   *
+   * @param name output name of the property
+   * @return propositions of the property, empty if it is not recorded
+   */
+  std::string propositions(const std::string& name) const;
+
+  /**
+   * Get the verdict recorded with a property
+   *
+   * @param name output name of the property
+   * @return verdict of the property, Undecided if it was written or is not
+   * recorded
+   */
+  Verdict verdict(const std::string& name) const;
+
+  /**
+   * Record a property generated from a net
+   *
+   * @param name output name of the property
+   * @param formula_hash hash of the LTL formula of the property
+   * @param dependencies parts of the net read by the translation
+   * @param digests digests of the current net
+   * @param propositions propositions of the property
+   * @param files hash of the files the property was generated from and
+   * written to, see is_up_to_date()
+   * @param verdict verdict of a property decided instead of being written
+   */
+  void update(const std::string& name, const std::string& formula_hash,
+              const std::set<std::string>& dependencies,
+              const std::map<std::string, std::string>& digests,
+              const std::string& propositions,
+              const std::map<std::string, std::string>& files,
+              Verdict verdict = Verdict::Undecided);
+
+  /**
+   * Record the files of a property again, without translating it
+   *
+   * @param name output name of the property, already recorded
+   * @param files hash of the files the property was generated from and
+   * written to
+   */
+  void update_files(const std::string& name, const std::map<std::string, std::string>& files);
+
+  /**
+   * Write the index back to its file
+   *
+   * The index is written to a temporary file and renamed, so that an
+   * interrupted run leaves the previous index rather than a truncated one.
+   */
+  void save() const;
+
+ private:
+  // path to the index file
+  std::string filename;
+
+  // properties indexed by output name
+  nlohmann::json properties;
+};
+
+}  // namespace LTL2PROP
+
+#endif  // INCREMENTALINDEX_HPP_
@@ -1,14 +1,30 @@
 #ifndef LTLTRANSLATOR_HPP_
 #define LTLTRANSLATOR_HPP_
 
+#include <cstdint>
+#include <functional>
 #include <json.hpp>
 #include <list>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
+#include "Net.hpp"
+#include "TaskScheduler.hpp"
 
 namespace LTL2PROP {
 
+/**
+ * Version of the translation, increased by every change of the properties
+ * or propositions it generates. Outputs cached or indexed by a translator of
+ * another version are generated again.
+ */
+const unsigned translation_version = 7;
+
 
 /**
  * @brief Class encapsulating the parser from LTL to Helena
@@ -23,6 +39,14 @@ class LTLTranslator {
    */
   LTLTranslator(const nlohmann::json& lna_json, const nlohmann::json& ltl_json);
 
+  /**
+   * Create a new LTL translator from an already loaded net
+   *
+   * @param net information of the CPN net, see load_net()
+   * @param ltl_json JSON object containing the information of the LTL formula
+   */
+  LTLTranslator(const Net& net, const nlohmann::json& ltl_json);
+
   /**
    * Translate a LTL formula into Helena code
    *
@@ -30,6 +54,52 @@ class LTLTranslator {
    */
   std::map<std::string, std::string> translate();
 
+  /**
+   * Translate another LTL formula against the already loaded net
+   *
+   * Query results cached by previous translations are reused.
+   *
+   * @param ltl_json JSON object containing the information of the LTL formula
+   * @return the propositions and the property in Helena code
+   */
+  std::map<std::string, std::string> translate(const nlohmann::json& ltl_json);
+
+  /**
+   * Generate the vulnerability formulas of an audit sweep
+   *
+   * Reentrancy, Timestamp Dependance, Skip Empty String Literal and Self
+   * Destruction formulas are generated for every function of every smart
+   * contract, and Uninitialized Storage Variable formulas for every global
+   * variable a function reads. The queries all of them ask are answered by
+   * a single batch of place queries, whose answers stay in the query cache
+   * so that translating the formulas doesn't scan the statements again.
+   *
+   * @return LTL formulas, to be given to translate()
+   */
+  std::vector<nlohmann::json> sweep();
+
+  /**
+   * Split the passes over the statements into subtasks of a scheduler
+   *
+   * Copies of the translator share the statements of the net, so each worker
+   * of the scheduler can translate with its own copy while the statements
+   * are scanned by any idle worker.
+   *
+   * @param _scheduler scheduler running the subtasks, nullptr to scan the
+   * statements on the calling thread
+   */
+  void set_scheduler(TaskScheduler* _scheduler);
+
+  /**
+   * Get the parts of the net read by the last translation
+   *
+   * Keys follow net_digests(): "function:<contract>::<function>",
+   * "variable:<name>", "variables", "calls" or "*" for the whole net.
+   *
+   * @return dependencies of the last translated property
+   */
+  const std::set<std::string>& get_dependencies() const;
+
   /**
    * Get the list of variables in a formula
    *
@@ -40,44 +110,277 @@ class LTLTranslator {
       const std::string& _formula);
 
  private:
-  struct Statement{
-				std::string type;
-				std::string smart_contract;
-				std::string parent;
-				std::string variable;
-				std::string function_name;
-				std::string input_place;
-				std::string output_place;		
-        std::string param_place;		
-				std::list<std::string> RHV;
-				bool timestamp;
-  };
-
   // output map of translate() function
   std::map<std::string, std::string> result = { {"property", ""}, {"propositions", ""}};
 
   // json that contrains vulnerability / property info
   nlohmann::json formula_json;
 
-  // all statements of selected smart contracts
-  nlohmann::json statement_list;
+  // places of the local variables, indexed by scoped_variable_name()
+  std::unordered_map<std::string, std::string> local_variables;
 
-  // all local variables of selected smart contracts
-  std::map<std::string, std::string> local_variables;
+  // places of the local variables, indexed by name only
+  std::unordered_map<std::string, std::string> unscoped_local_variables;
+
+  // local variable names declared in several places, which need a scope
+  std::unordered_set<std::string> ambiguous_local_variables;
 
   // all global variables of selected smart contracts
-  std::list<std::string> global_variables;
+  std::unordered_set<std::string> global_variables;
+
+  // maximal number of tokens of the places whose capacity is known
+  std::map<std::string, unsigned> place_capacities;
+
+  // def-use edges of a function: a variable maps to the variables whose
+  // definition (assignment or declaration) reads it
+  typedef std::unordered_map<std::string, std::vector<std::string>> DefUseEdges;
+
+  // (smart contract, function)
+  typedef std::pair<std::string, std::string> FunctionScope;
+
+  // consecutive statements of the same type, scanned by a single subtask
+  struct StatementRange {
+    std::string type;
+    std::list<Statement>::const_iterator begin, end;
+  };
+
+  /**
+   * @brief Statements of the net, never modified once loaded
+   */
+  struct StatementStore {
+    // each type of statement has its own list
+    std::list<Statement> assignments,
+     sendings, selections, function_calls,
+    variable_declarations, returnings, requirements,
+     for_loops, while_loops;
+
+    // def-use graph of all functions, indexed by function then smart contract
+    std::unordered_map<std::string, std::unordered_map<std::string, DefUseEdges>> def_use_graph;
+
+    // call graph from the function_calls, a caller maps to the functions it
+    // calls; functions are named without their smart contract, which the
+    // call statements don't give for the callee
+    std::unordered_map<std::string, std::vector<std::string>> call_graph;
+
+    // functions the net runs: its entry points and their callees, transitively
+    std::unordered_set<std::string> reachable_functions;
+
+    // true when the net gives its entry points, every function is reachable otherwise
+    bool has_entry_points = false;
+
+    // functions each function calls directly; a callee is looked for in the
+    // smart contract of the call, then in every smart contract defining a
+    // function of that name
+    std::map<FunctionScope, std::vector<FunctionScope>> callees;
+
+    // strongly connected component of each function of the call graph, the
+    // functions of a component all have the same callees
+    std::map<FunctionScope, std::size_t> call_components;
+
+    // the statement lists in the order they are scanned, cut in ranges
+    std::vector<StatementRange> ranges;
+  };
+
+  // statements shared by the copies of the translator
+  std::shared_ptr<const StatementStore> statement_store;
+
+  // scheduler of the passes over the statements, if any
+  TaskScheduler* scheduler = nullptr;
+
+
+
+
+
+
+  // queries answered by the get_* helpers, used to key the query cache
+  enum queries {
+    SendingOutputPlaces,
+    SelectionOutputPlaces,
+    BalanceVariables,
+    ForLoopsOutputPlaces,
+    WhileLoopsOutputPlaces,
+    RequireOutputPlaces,
+    FunctionCallOutputPlaces,
+    FunctionCallInputPlaces,
+    TimestampPlaces,
+    WriteOutputPlaces,
+    ReadOutputPlaces,
+    FunctionCallParamPlaces,
+    BalanceVariablesTestingOutputPlaces,
+    BalanceVariablesWriteStatements
+  };
+
+  // a query key is the query followed by the ids of its interned arguments
+  typedef std::vector<std::uint32_t> QueryKey;
+
+  struct QueryKeyHash {
+    std::size_t operator()(const QueryKey& key) const;
+  };
+
+  // ids of the strings used as query arguments
+  std::unordered_map<std::string, std::uint32_t> interned_strings;
+
+  // results of the get_* helpers for the loaded net
+  std::unordered_map<QueryKey, std::list<std::string>, QueryKeyHash> query_cache;
+
+  // functions called, directly or not, by the functions of a component of
+  // the call graph, with the functions of the component; computed on the
+  // first query of the component only, since storing the closure of every
+  // component is quadratic on chains of calls
+  std::unordered_map<std::size_t, std::vector<FunctionScope>> callee_closures;
+
+  // parts of the net read by the current translation
+  std::set<std::string> dependencies;
+
+  /**
+   * Record the parts of the net a query reads
+   *
+   * @param query the query being answered
+   * @param args its scalar arguments
+   */
+  void record_dependencies(queries query, const std::vector<std::string>& args);
+
+  // statement field compared to the function of a place query
+  enum functionMatches {
+    ParentMatch,        // function containing the statement
+    FunctionNameMatch,  // function field, the called function for function calls
+    EnclosingFunction,  // parent of function calls, function field of other statements
+    AnyFunction
+  };
+
+  // use of the variable of a place query by a statement
+  enum variableMatches {
+    AnyVariable,
+    TestedVariable,       // variable field, or else each right hand occurrence
+    ReadVariable,         // each right hand occurrence
+    WrittenVariable,      // variable field
+    InitializedVariable   // variable field, with right hand variables
+  };
+
+  enum placeFields { InputPlace, OutputPlace, ParamPlace };
+
+  /**
+   * @brief Places to collect from the statements matching some criteria
+   */
+  struct PlaceQuery {
+    std::set<std::string> types;  // types of statements, every type if empty
+    std::string smart_contract;
+    bool any_contract = false;
+    std::string function;
+    functionMatches function_match = ParentMatch;
+    std::string variable;
+    variableMatches variable_match = AnyVariable;
+    bool timestamp = false;  // only statements using a timestamp
+    placeFields place = OutputPlace;
+    bool skip_empty_places = true;
+    bool unique = true;  // remove consecutive duplicate places
+    bool reachable_only = false;  // only statements of the functions the net runs
+
+    bool operator<(const PlaceQuery& other) const;
+  };
+
+  /**
+   * Return the statement lists with their type, in the order they are scanned
+   */
+  std::vector<std::pair<std::string, const std::list<Statement>*>> statement_lists() const;
+
+  /**
+   * Describe a get_* query as place queries
+   *
+   * @param query the query being answered
+   * @param args its scalar arguments
+   * @return place queries whose places, concatenated, answer the query
+   */
+  std::vector<PlaceQuery> place_queries(queries query, const std::vector<std::string>& args) const;
+
+  /**
+   * Add the places of a statement matching a place query
+   *
+   * @param query place query
+   * @param type type of the statement
+   * @param statement statement to be tested
+   * @param places places collected so far
+   */
+  void collect_places(const PlaceQuery& query, const std::string& type,
+                      const Statement& statement, std::list<std::string>& places) const;
+
+  /**
+   * Add the places of a range of statements matching place queries
+   *
+   * @param place_queries place queries
+   * @param range statements to be tested
+   * @param places places of each query collected so far
+   */
+  void collect_range(const std::vector<PlaceQuery>& place_queries, const StatementRange& range,
+                     std::vector<std::list<std::string>>& places) const;
 
-  // each type of statement has its own list
-  std::list<Statement> assignments,
-   sendings, selections, function_calls,
-  variable_declarations, returnings, requirements,
-   for_loops, while_loops;
+  /**
+   * Answer place queries with a single pass over the statements
+   *
+   * With a scheduler, each range of statements is scanned by a subtask.
+   *
+   * @param place_queries queries to be answered
+   * @return places of each query
+   */
+  std::vector<std::list<std::string>> run_queries(const std::vector<PlaceQuery>& place_queries) const;
 
+  /**
+   * Answer several get_* queries at once, reusing cached results
+   *
+   * Queries missing from the cache are answered by a single pass over the
+   * statements, and their results are cached.
+   *
+   * @param batch queries with their scalar arguments
+   * @return places of each query
+   */
+  std::vector<std::list<std::string>> answer_batch(
+      const std::vector<std::pair<queries, std::vector<std::string>>>& batch);
 
+  /**
+   * Answer a single get_* query, see answer_batch()
+   *
+   * @param query the query being answered
+   * @param args its scalar arguments
+   * @return places answering the query
+   */
+  std::list<std::string> answer(queries query, const std::vector<std::string>& args);
+
+  /**
+   * Store a query result computed outside of its get_* helper
+   *
+   * @param key cache key built by query_key()
+   * @param places places or variables answering the query
+   */
+  void seed(const QueryKey& key, std::list<std::string> places);
 
+  /**
+   * Return the id of a query argument, assigning a new one on first use
+   *
+   * @param _value query argument
+   * @return id of the argument
+   */
+  std::uint32_t intern(const std::string& _value);
 
+  /**
+   * Build the cache key of a query
+   *
+   * @param query the query being answered
+   * @param args its scalar arguments
+   * @param list_arg its list argument, if any
+   * @return cache key
+   */
+  QueryKey query_key(queries query, const std::vector<std::string>& args,
+                     const std::list<std::string>& list_arg = {});
 
+  /**
+   * Return the cached result of a query, computing it on the first call
+   *
+   * @param key cache key built by query_key()
+   * @param compute function answering the query
+   * @return places or variables answering the query
+   */
+  const std::list<std::string>& memoize(
+      const QueryKey& key, const std::function<std::list<std::string>()>& compute);
 
   // vulnerabilities and properties
   enum vulnerabilities {
@@ -112,11 +415,11 @@ class LTLTranslator {
   void createMap();
 
   /**
-   * Parse global/local variables from a CPN JSON object
+   * Store global/local variables and statements of a CPN net
    *
-   * @param lna_json JSON object containing information about a CPN net
+   * @param net information about a CPN net
    */
-  void handleVariable(const nlohmann::json& lna_json);
+  void handleVariable(const Net& net);
 
   /**
    * Check if _name is a constant
@@ -152,22 +455,81 @@ class LTLTranslator {
    */
   bool is_local_variable(const std::string& _name) const;
 
+  /**
+   * Build the key of a local variable in local_variables
+   *
+   * @param _smart_contract smart contract of the function
+   * @param _function function declaring the variable
+   * @param _name name of the variable
+   * @return key of the variable
+   */
+  static std::string scoped_variable_name(const std::string& _smart_contract, const std::string& _function,
+                                          const std::string& _name);
+
+  /**
+   * Return the place holding a variable, S for global variables
+   *
+   * A local variable of the function shadows a global variable of the same
+   * name. Without a function, the variable is looked up by name only, the
+   * globals first.
+   *
+   * @param _name name of the variable
+   * @param _function function the variable is used in, empty if unknown
+   * @param _smart_contract smart contract of the function
+   * @return name of the place
+   * @throws std::runtime_error if the variable doesn't exist, or if the name
+   * of a local variable is ambiguous
+   */
+  std::string get_variable_place(const std::string& _name, const std::string& _function = "",
+                                 const std::string& _smart_contract = "") const;
+
+  /**
+   * Check if a place holds at most one token
+   *
+   * @param _place name of the place
+   * @return true for S and the places of capacity 1, false otherwise
+   */
+  bool is_singleton_place(const std::string& _place) const;
+
+  /**
+   * Return the cheapest Helena expression comparing two variables
+   *
+   * Variables held by the same singleton place are compared on a single
+   * token, other ones on each pair of tokens of their places.
+   *
+   * @param variable left variable
+   * @param comparison Helena comparison operator
+   * @param rival_variable right variable
+   * @param function function both variables are used in, empty if unknown
+   * @param smart_contract smart contract of 'function'
+   * @return Helena expression
+   */
+  std::string get_variable_comparison(const std::string& variable, const std::string& comparison,
+                                      const std::string& rival_variable, const std::string& function,
+                                      const std::string& smart_contract) const;
+
   /**
    * Return the place modelling the local variable
    *
    * @param _name name of the local variable
-   * @return name of the place
+   * @param _function function declaring the variable, empty if unknown
+   * @param _smart_contract smart contract of the function
+   * @return name of the place, empty if the variable isn't local
    */
-  std::string get_local_variable_placetype(const std::string& _name);
+  std::string get_local_variable_placetype(const std::string& _name, const std::string& _function = "",
+                                           const std::string& _smart_contract = "");
 
   /**
    * Return the Helena code for the "Integer Overflow/Underflow" vulnerability
      @param variable variable being tested
      @param min_threshold minimum threshold value
      @param max_threshold maximum threshold value
+     @param function function 'variable' is used in, empty if unknown
+     @param smart_contract smart contract of 'function'
    * @return Helena code
    */
-    std::map<std::string, std::string> detectIntegerUnderOverFlow(std::string variable, std::string min_threshold, std::string max_threshold);
+    std::map<std::string, std::string> detectIntegerUnderOverFlow(std::string variable, std::string min_threshold, std::string max_threshold,
+                                                                  std::string function, std::string smart_contract);
       
   /**
    * Return the Helena code for the "Reentrancy" vulnerability
@@ -225,9 +587,12 @@ class LTLTranslator {
     * @param variable 
     * @param rival_variable 
     * @param max_threshold 
+    * @param function function both variables are used in, empty if unknown
+    * @param smart_contract smart contract of 'function'
     * @return Helena code
     */
-  std::map<std::string, std::string> checkVariableAlwaysLessThan(std::string variable, std::string rival_variable, std::string max_threshold);
+  std::map<std::string, std::string> checkVariableAlwaysLessThan(std::string variable, std::string rival_variable, std::string max_threshold,
+                                                                 std::string function, std::string smart_contract);
 
   /**
     * @brief Return the helena code that checks that a variable's value is always more than another variable/constant
@@ -235,9 +600,12 @@ class LTLTranslator {
     * @param variable 
     * @param rival_variable 
     * @param min_threshold 
+    * @param function function both variables are used in, empty if unknown
+    * @param smart_contract smart contract of 'function'
     * @return Helena code of property to be verified and its propositions 
     */
-  std::map<std::string, std::string> checkVariableAlwaysMoreThan(std::string variable, std::string rival_variable, std::string min_threshold);
+  std::map<std::string, std::string> checkVariableAlwaysMoreThan(std::string variable, std::string rival_variable, std::string min_threshold,
+                                                                 std::string function, std::string smart_contract);
 
   /**
     * @brief Return the helena code that checks that a variable's value is always equal another variable/constant
@@ -245,9 +613,12 @@ class LTLTranslator {
     * @param variable 
     * @param rival_variable 
     * @param constant 
+    * @param function function both variables are used in, empty if unknown
+    * @param smart_contract smart contract of 'function'
     * @return Helena code of property to be verified and its propositions 
     */
-  std::map<std::string, std::string> checkVariableAlwaysEqualTo(std::string variable, std::string rival_variable, std::string constant);
+  std::map<std::string, std::string> checkVariableAlwaysEqualTo(std::string variable, std::string rival_variable, std::string constant,
+                                                                std::string function, std::string smart_contract);
 
   /**
     * @brief 
@@ -380,6 +751,9 @@ class LTLTranslator {
   /**
     * @brief Return variables that represent the balance of 'smart contract' 
     * 
+    * Variables are collected transitively over the def-use graph, so
+    * 'b' is a balance variable in `a = address(this).balance; b = a;`
+    * 
     * @param function look for variables inside 'function'
     * @param smart_contract parent contract of 'function'
     * 
@@ -469,6 +843,19 @@ class LTLTranslator {
     * @return output places of statements that assign values to variables representing the balance inside 'function'
   */   
   std::list<std::string> get_balance_variables_write_statements(std::list<std::string> balance_variables, std::string function, std::string smart_contract);
+
+  /**
+    * @brief Return a function followed by the functions it calls, directly or not
+    *
+    * The closure of the callees is computed on the first call for the
+    * function, and kept for the next ones.
+    *
+    * @param function
+    * @param smart_contract smart contract that contains 'function'
+    *
+    * @return (smart contract, function) of 'function' and of its callees
+  */
+  std::vector<FunctionScope> get_function_and_callees(const std::string& function, const std::string& smart_contract);
     
 
 };
@@ -0,0 +1,135 @@
+#ifndef LTLFORMULA_HPP_
+#define LTLFORMULA_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace LTL2PROP {
+
+/**
+ * @brief LTL formula of a Helena property, as a syntax tree
+ */
+struct LtlFormula {
+  enum Kind { Atom, True, False, Not, Always, Eventually, Until, And, Or, Implies };
+
+  Kind kind;
+  // name of the proposition of an atom
+  std::string atom;
+  // one operand for unary operators, two for binary ones
+  std::vector<LtlFormula> operands;
+};
+
+/**
+ * @brief Helena property: ltl property <name>: <formula>;
+ */
+struct LtlProperty {
+  std::string name;
+  LtlFormula formula;
+};
+
+/**
+ * @brief Quantification of a proposition: exists (t in P, t2 in Q | condition)
+ */
+struct Quantification {
+  std::vector<std::string> places;
+  std::string condition;
+};
+
+/**
+ * @brief Helena proposition: proposition <name>: <expression>;
+ */
+struct Proposition {
+  std::string name;
+  std::string expression;
+  // places whose cardinality is tested outside of quantifications
+  std::vector<std::string> places;
+  std::vector<Quantification> quantifications;
+
+  /**
+   * Get the kind of predicate of the proposition
+   *
+   * @return quantified, cardinality, or constant if it reads no place
+   */
+  std::string kind() const;
+};
+
+/**
+ * Parse a property generated by the translator
+ *
+ * Operators are not, [], <>, until, and, or, =>, from the tightest to the
+ * loosest.
+ *
+ * @param property text of the property
+ * @return parsed property
+ * @throws std::runtime_error if the property cannot be parsed
+ */
+LtlProperty parse_ltl_property(const std::string& property);
+
+/**
+ * Parse the propositions generated by the translator, one per line
+ *
+ * Lines that aren't propositions are skipped, as well as a proposition
+ * already defined by a previous line.
+ *
+ * @param propositions text of the propositions
+ * @return propositions, in the order they are defined
+ */
+std::vector<Proposition> parse_propositions(const std::string& propositions);
+
+/**
+ * Get the propositions defined as true or false
+ *
+ * Templates finding nothing to check define such propositions, e.g.
+ * proposition write: false;
+ *
+ * @param propositions parsed propositions
+ * @return value of each constant proposition, by name
+ */
+std::map<std::string, bool> constant_propositions(const std::vector<Proposition>& propositions);
+
+/**
+ * Simplify a formula by propagating its constants
+ *
+ * Constant propositions are replaced by their value, which is propagated
+ * through the operators: not true is false, [] c and <> c are c, p until
+ * true is true, p until false is false, false until p is p, true until p is
+ * <> p, false => p is true, true => p is p, and true and false are the
+ * neutral or absorbing elements of and/or.
+ *
+ * @param formula the formula
+ * @param constants value of the constant propositions, by name
+ * @return equivalent formula, True or False if it is decided
+ */
+LtlFormula simplify(const LtlFormula& formula, const std::map<std::string, bool>& constants);
+
+/**
+ * @brief Verdict of a property decided without exploring the state space
+ */
+enum class Verdict { Undecided, Holds, Violated };
+
+/**
+ * Decide a property generated by the translator without exploring the state
+ * space of the net
+ *
+ * A property is decided when its formula simplifies to true or false once
+ * its constant propositions are replaced by their value.
+ *
+ * @param property text of the property
+ * @param propositions text of the propositions
+ * @return Holds or Violated if the formula simplifies to true or false,
+ * Undecided otherwise or if the property cannot be parsed
+ */
+Verdict static_verdict(const std::string& property, const std::string& propositions);
+
+/**
+ * Write a formula back in Helena syntax
+ *
+ * @param formula the formula
+ * @return text of the formula, fully parenthesized
+ */
+std::string to_string(const LtlFormula& formula);
+
+}  // namespace LTL2PROP
+
+#endif  // LTLFORMULA_HPP_
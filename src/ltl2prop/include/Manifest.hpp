@@ -0,0 +1,85 @@
+#ifndef MANIFEST_HPP_
+#define MANIFEST_HPP_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Net.hpp"
+
+namespace LTL2PROP {
+
+/**
+ * @brief Statements of a net indexed by the places modelling them
+ *
+ * The index refers to the statements of the net, which must outlive it.
+ */
+class PlaceIndex {
+ public:
+  /**
+   * Index the input, output and param places of the statements of a net
+   *
+   * @param _net the net
+   */
+  explicit PlaceIndex(const Net& _net);
+
+  /**
+   * Get the statements modelled by a place
+   *
+   * @param place name of the place
+   * @return positions of the statements in the net, in increasing order
+   */
+  const std::vector<std::size_t>& statements(const std::string& place) const;
+
+  /**
+   * Get the number of statements of the net
+   *
+   * @return number of statements
+   */
+  std::size_t statement_count() const;
+
+  /**
+   * Get a statement of the net
+   *
+   * @param position position of the statement in the net
+   * @return statement
+   */
+  const Statement& statement(std::size_t position) const;
+
+ private:
+  const Net& net;
+  std::unordered_map<std::string, std::vector<std::size_t>> place_statements;
+};
+
+/**
+ * Describe a translated property for the tools reading the outputs
+ *
+ * The manifest gives the name of the property, its class (constant when the
+ * property is true or false once its constant propositions are simplified,
+ * see static_verdict(), until, liveness, invariant, or state for a property
+ * of the initial state only), each proposition with its kind of
+ * predicate, its places and whether the formula uses it, and the statements
+ * of the net modelled by these places:
+ * \code
+ * {"property": "reentrancy", "class": "until", "constant": null,
+ *  "propositions": [{"name": "assignmentBank_withdraw_asg_b", "kind": "cardinality",
+ *                    "places": ["Bank_withdraw_asg_b"], "used": true,
+ *                    "statements": [1]}],
+ *  "statements": [{"index": 1, "type": "assignment", "smart_contract": "Bank",
+ *                  "function": "withdraw", "input_place": "",
+ *                  "output_place": "Bank_withdraw_asg_b", "param_place": ""}]}
+ * \endcode
+ * Statements are indexed by their position in the loaded net; function calls
+ * also give their "called_function".
+ *
+ * @param translation property and propositions returned by LTLTranslator::translate
+ * @param index statements of the translated net
+ * @return manifest, as compact JSON text
+ */
+std::string translation_manifest(const std::map<std::string, std::string>& translation,
+                                 const PlaceIndex& index);
+
+}  // namespace LTL2PROP
+
+#endif  // MANIFEST_HPP_
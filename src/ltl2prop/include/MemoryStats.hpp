@@ -0,0 +1,61 @@
+#ifndef MEMORYSTATS_HPP_
+#define MEMORYSTATS_HPP_
+
+namespace LTL2PROP {
+
+/**
+ * @brief Phases heap allocations are accounted to
+ */
+enum class MemoryPhase {
+  // allocations outside of any phase
+  Other,
+  // JSON documents of the formula and of the lna-info
+  JsonDom,
+  // net, statement lists and def-use graph of the translator
+  StatementStore,
+  // place lists computed and cached by the queries
+  QueryResults,
+  // properties and propositions built by the templates
+  OutputStrings,
+};
+
+/**
+ * @brief Phase of the allocations of the current thread, from its
+ * construction to its destruction
+ */
+class MemoryPhaseScope {
+ public:
+  /**
+   * Account the following allocations of the thread to a phase
+   *
+   * @param phase the phase
+   */
+  explicit MemoryPhaseScope(MemoryPhase phase);
+
+  /**
+   * Go back to the previous phase
+   */
+  ~MemoryPhaseScope();
+
+  MemoryPhaseScope(const MemoryPhaseScope&) = delete;
+  MemoryPhaseScope& operator=(const MemoryPhaseScope&) = delete;
+
+ private:
+  MemoryPhase previous_phase;
+};
+
+}  // namespace LTL2PROP
+
+// with LTL2PROP_MEMORY_STATS, the global allocation functions are replaced and
+// the peak heap size, the allocations of each phase and a size-class
+// histogram are printed on stderr at exit
+#ifdef LTL2PROP_MEMORY_STATS
+#define LTL2PROP_MEMORY_CONCAT_(a, b) a##b
+#define LTL2PROP_MEMORY_CONCAT(a, b) LTL2PROP_MEMORY_CONCAT_(a, b)
+#define LTL2PROP_MEMORY_PHASE(phase) \
+  ::LTL2PROP::MemoryPhaseScope LTL2PROP_MEMORY_CONCAT(memory_phase_, __LINE__)(::LTL2PROP::MemoryPhase::phase)
+#else
+#define LTL2PROP_MEMORY_PHASE(phase)
+#endif
+
+#endif  // MEMORYSTATS_HPP_
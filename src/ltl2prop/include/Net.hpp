@@ -0,0 +1,78 @@
+#ifndef NET_HPP_
+#define NET_HPP_
+
+#include <json.hpp>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace LTL2PROP {
+
+/**
+ * @brief Statement of a smart contract and the places modelling it
+ */
+struct Statement {
+  std::string type;
+  std::string smart_contract;
+  std::string parent;
+  std::string variable;
+  std::string function_name;
+  std::string input_place;
+  std::string output_place;
+  std::string param_place;
+  std::list<std::string> RHV;
+  bool timestamp;
+};
+
+/**
+ * @brief Local variable of a function and the place modelling it
+ */
+struct LocalVariable {
+  std::string smart_contract;
+  std::string function;
+  std::string name;
+  std::string place;
+};
+
+/**
+ * @brief Information of a CPN net needed by the translator, as produced by
+ * solidity2cpn
+ */
+struct Net {
+  std::list<std::string> global_variables;
+  std::vector<LocalVariable> local_variables;
+  std::vector<Statement> statements;
+  // maximal number of tokens of the places whose capacity is known
+  std::map<std::string, unsigned> place_capacities;
+  // functions starting the executions modelled by the net, when solidity2cpn
+  // provides them; every function may start an execution otherwise
+  std::vector<std::string> entry_points;
+
+  /**
+   * Move the content of another net at the end of this one
+   *
+   * @param other net to be appended
+   */
+  void append(Net&& other);
+};
+
+/**
+ * Read a statement from its lna-info JSON object
+ *
+ * @param statement JSON object of the statement
+ * @return statement
+ */
+Statement statement_from_json(const nlohmann::json& statement);
+
+/**
+ * Read a net from its lna-info JSON object
+ *
+ * @param lna_json JSON object containing the information of the CPN net
+ * @return net
+ */
+Net net_from_json(const nlohmann::json& lna_json);
+
+}  // namespace LTL2PROP
+
+#endif  // NET_HPP_
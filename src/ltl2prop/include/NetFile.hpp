@@ -0,0 +1,34 @@
+#ifndef NETFILE_HPP_
+#define NETFILE_HPP_
+
+#include <string>
+
+namespace LTL2PROP {
+
+/**
+ * Copy a file, sharing its blocks when the filesystem allows it
+ *
+ * The copy is a reflink (FICLONE) on filesystems supporting it, a kernel-side
+ * copy (copy_file_range) otherwise, and a plain read/write copy on other
+ * platforms. An existing destination is overwritten.
+ *
+ * @param source path to the file to be copied
+ * @param destination path to the copy
+ */
+void clone_file(const std::string& source, const std::string& destination);
+
+/**
+ * Add propositions at the end of a Helena net
+ *
+ * Only the tail of the file is read and rewritten: the propositions are
+ * inserted in place of the last closing brace, which is written back after
+ * them.
+ *
+ * @param filename path to the net (.lna)
+ * @param propositions propositions to be added
+ */
+void append_propositions(const std::string& filename, const std::string& propositions);
+
+}  // namespace LTL2PROP
+
+#endif  // NETFILE_HPP_
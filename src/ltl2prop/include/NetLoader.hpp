@@ -0,0 +1,177 @@
+#ifndef NETLOADER_HPP_
+#define NETLOADER_HPP_
+
+#include <json.hpp>
+#include <map>
+#include <set>
+#include <string>
+#include "Net.hpp"
+
+namespace LTL2PROP {
+
+/**
+ * @brief Part of a net that an LTL formula can reference
+ *
+ * Statements outside of the scope are skipped while the lna-info is parsed.
+ */
+struct NetScope {
+  // true when the formula may reference any statement of the net
+  bool whole_net = true;
+
+  // referenced smart contracts, mapped to the referenced functions
+  // (an empty set of functions means every function of the contract)
+  std::map<std::string, std::set<std::string>> contracts;
+
+  // types of statements kept whatever their smart contract
+  std::set<std::string> unscoped_types;
+
+  // true when local variables of any function may be referenced
+  bool all_functions = false;
+
+  // true when only the statements of unscoped types and the entry points
+  // are read, e.g. from the shard of a contract the formula doesn't reference
+  bool calls_only = false;
+
+  /**
+   * Check if a statement of the lna-info belongs to the scope
+   *
+   * @param statement the statement
+   * @return true if the statement must be loaded, false otherwise
+   */
+  bool contains(const Statement& statement) const;
+
+  /**
+   * Check if a smart contract is referenced by the scope
+   *
+   * The shard of a contract that is not referenced is only read for its
+   * statements of unscoped types and its entry points, if there are
+   * unscoped types.
+   *
+   * @param smart_contract name of the smart contract
+   * @return true if the contract's shard must be loaded, false otherwise
+   */
+  bool references(const std::string& smart_contract) const;
+};
+
+/**
+ * @brief JSON parsers able to read an lna-info
+ */
+enum class JsonBackend {
+  // nlohmann::json DOM, statements are read from the parsed document
+  Dom,
+  // nlohmann::json SAX events, statements are read without building a document
+  Sax
+};
+
+/**
+ * Get the backend chosen at build time (LTL2PROP_JSON_BACKEND)
+ *
+ * @return default backend
+ */
+JsonBackend default_json_backend();
+
+/**
+ * Get a backend from its name
+ *
+ * @param name "dom" or "sax"
+ * @return backend
+ */
+JsonBackend json_backend_from_name(const std::string& name);
+
+/**
+ * Get the name of a backend
+ *
+ * @param backend the backend
+ * @return "dom" or "sax"
+ */
+std::string json_backend_name(JsonBackend backend);
+
+/**
+ * Work out the contracts and functions an LTL formula can reference
+ *
+ * @param ltl_json JSON object containing the information of the LTL formula
+ * @return scope of the formula, the whole net if it cannot be narrowed
+ */
+NetScope formula_scope(const nlohmann::json& ltl_json);
+
+/**
+ * Parse an lna-info JSON text, skipping statements outside of a scope
+ *
+ * @param content JSON text produced by solidity2cpn
+ * @param scope part of the net to keep
+ * @param backend JSON parser to be used
+ * @return net
+ */
+Net parse_net(const std::string& content, const NetScope& scope = NetScope(),
+              JsonBackend backend = default_json_backend());
+
+/**
+ * Read an lna-info file, skipping statements outside of a scope
+ *
+ * The file is either a single lna-info bundle or a shard manifest:
+ * \code{.json}
+ * {
+ *   "global_variables": [ ... ],
+ *   "shards": [ { "smart_contract": "Bank", "path": "Bank.json" }, ... ]
+ * }
+ * \endcode
+ * Each shard holds the "global_variables", "functions" and "statements" of
+ * one smart contract, its path is relative to the manifest. Only the shards
+ * of the contracts in the scope are read, and they are merged into a single
+ * net; the other shards are read in calls-only mode when the scope has
+ * unscoped types, so that the call graph covers the whole net. The manifest may also list the "functions" of all contracts, so that
+ * formulas on variables need no shard at all.
+ *
+ * @param filename path to the lna-info file or to the shard manifest
+ * @param scope part of the net to keep
+ * @param backend JSON parser to be used
+ * @return net
+ */
+Net load_net(const std::string& filename, const NetScope& scope = NetScope(),
+             JsonBackend backend = default_json_backend());
+
+/**
+ * Read the content of an lna-info file, to be parsed by parse_net_file()
+ *
+ * Reading and parsing are split so that they can run in different stages
+ * of a pipeline.
+ *
+ * @param filename path to the lna-info file or to the shard manifest
+ * @return content of the file
+ */
+std::string read_net_file(const std::string& filename);
+
+/**
+ * Parse an lna-info file read by read_net_file(), see load_net()
+ *
+ * @param filename path to the file, shards of a manifest are read relative to it
+ * @param content content of the file
+ * @param scope part of the net to keep
+ * @param backend JSON parser to be used
+ * @return net
+ */
+Net parse_net_file(const std::string& filename, const std::string& content,
+                   const NetScope& scope = NetScope(), JsonBackend backend = default_json_backend());
+
+/**
+ * Hash the content of an lna-info file without parsing its statements
+ *
+ * The hash of a shard manifest covers the manifest and all of its shards.
+ *
+ * @param filename path to the lna-info file or to the shard manifest
+ * @return hexadecimal digest
+ */
+std::string net_file_hash(const std::string& filename);
+
+/**
+ * Hash an lna-info file read by read_net_file(), see net_file_hash()
+ *
+ * @param filename path to the file, shards of a manifest are read relative to it
+ * @param content content of the file
+ * @return hexadecimal digest
+ */
+std::string net_content_hash(const std::string& filename, const std::string& content);
+
+}  // namespace LTL2PROP
+
+#endif  // NETLOADER_HPP_
@@ -0,0 +1,70 @@
+#ifndef OUTPUTCACHE_HPP_
+#define OUTPUTCACHE_HPP_
+
+#include <json.hpp>
+#include <map>
+#include <string>
+
+namespace LTL2PROP {
+
+/**
+ * @brief Directory of previous translation outputs, addressed by a hash of
+ * their inputs
+ *
+ * The key of a translation hashes the lna-info (see net_file_hash()), the
+ * formula, the options changing the outputs and the translation_version, so
+ * a cached translation is found without loading the net. Each entry <key>.entry holds the outputs of
+ * a translation: "property" and "propositions", and the "cost" report and
+ * "manifest" when they were asked for. Outputs are stored as frames
+ * #<output> <length>\n<content>, so reading an entry parses no JSON.
+ */
+class OutputCache {
+ public:
+  /**
+   * Open a cache
+   *
+   * @param _directory existing directory of the entries
+   */
+  explicit OutputCache(const std::string& _directory);
+
+  /**
+   * Compute the key of a translation
+   *
+   * The formula is normalized: its keys are sorted and its whitespace is
+   * dropped.
+   *
+   * @param net_hash hash of the lna-info
+   * @param ltl_json JSON object containing the information of the LTL formula
+   * @param options options changing the outputs, e.g. the token bound of cost reports
+   * @return key of the entry
+   */
+  static std::string key(const std::string& net_hash, const nlohmann::json& ltl_json,
+                         const std::string& options);
+
+  /**
+   * Read the outputs of a translation
+   *
+   * @param key key of the entry
+   * @param outputs set to the cached outputs
+   * @return true if the entry exists, false otherwise
+   */
+  bool lookup(const std::string& key, std::map<std::string, std::string>& outputs) const;
+
+  /**
+   * Write the outputs of a translation
+   *
+   * The entry is written to a temporary file and renamed, so that concurrent
+   * runs sharing the directory never read a partial entry.
+   *
+   * @param key key of the entry
+   * @param outputs outputs to be cached
+   */
+  void store(const std::string& key, const std::map<std::string, std::string>& outputs) const;
+
+ private:
+  std::string directory;
+};
+
+}  // namespace LTL2PROP
+
+#endif  // OUTPUTCACHE_HPP_
@@ -0,0 +1,198 @@
+#ifndef PIPELINE_HPP_
+#define PIPELINE_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "TaskScheduler.hpp"
+
+namespace LTL2PROP {
+
+/**
+ * @brief Queue between two stages of a pipeline
+ *
+ * A producer is blocked while the queue is full, a consumer while it is
+ * empty, so a fast stage waits for a slow one instead of piling up items.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * Create an empty queue
+   *
+   * @param _capacity number of items the queue holds at most, at least one
+   */
+  explicit BoundedQueue(std::size_t _capacity) : capacity(_capacity > 0 ? _capacity : 1) {}
+
+  /**
+   * Add an item at the back of the queue, waiting for a free slot
+   *
+   * @param value item to be added
+   */
+  void push(T value) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_full.wait(lock, [this] { return values.size() < capacity; });
+    values.push_back(std::move(value));
+    not_empty.notify_one();
+  }
+
+  /**
+   * Take the item at the front of the queue, waiting for one
+   *
+   * @param value set to the item taken
+   * @return true if an item was taken, false if the queue is closed and empty
+   */
+  bool pop(T& value) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_empty.wait(lock, [this] { return !values.empty() || closed; });
+    if (values.empty()) return false;
+    value = std::move(values.front());
+    values.pop_front();
+    not_full.notify_one();
+    return true;
+  }
+
+  /**
+   * Tell the consumers that no item will be added any more
+   */
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    not_empty.notify_all();
+  }
+
+ private:
+  std::mutex mutex;
+  std::condition_variable not_full;
+  std::condition_variable not_empty;
+  std::deque<T> values;
+  std::size_t capacity;
+  bool closed = false;
+};
+
+/**
+ * Run the items of a batch through read, process and write stages
+ *
+ * Items are read by a reader thread, processed by tasks of the scheduler and
+ * written by a writer thread, the three stages running at once. At most
+ * 'capacity' items are in flight, from the start of their reading to the end
+ * of their writing, so the stages wait for the slowest one and memory stays
+ * bounded.
+ * Errors of an item are expected to be stored in the item; an exception
+ * escaping a stage stops its items from reaching the next stages and is
+ * thrown once the batch is done.
+ *
+ * @param scheduler scheduler running the process stage
+ * @param capacity number of items in flight at most
+ * @param read fill the next item, return false at the end of the batch
+ * @param process process an item
+ * @param write write an item
+ * @param ordered write the items in the order they were read
+ */
+template <typename Item>
+void run_pipeline(TaskScheduler& scheduler, std::size_t capacity,
+                  const std::function<bool(Item&)>& read,
+                  const std::function<void(Item&)>& process,
+                  const std::function<void(Item&)>& write,
+                  bool ordered) {
+  // an item with its rank in the batch, and whether it made it through its stage
+  struct Sequenced {
+    std::size_t rank;
+    bool ok;
+    Item item;
+  };
+
+  BoundedQueue<std::shared_ptr<Sequenced>> read_items(capacity);
+  BoundedQueue<std::shared_ptr<Sequenced>> processed_items(capacity);
+  // one token per item in flight, released once the item is written
+  BoundedQueue<bool> in_flight(capacity);
+
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  auto record_error = [&error_mutex, &error]() {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    if (!error) error = std::current_exception();
+  };
+
+  std::thread reader([&]() {
+    bool token;
+    try {
+      for (std::size_t rank = 0;; ++rank) {
+        in_flight.push(true);
+        std::shared_ptr<Sequenced> sequenced(new Sequenced{rank, true, Item()});
+        if (!read(sequenced->item)) {
+          in_flight.pop(token);
+          break;
+        }
+        read_items.push(std::move(sequenced));
+      }
+    }
+    catch (...) {
+      in_flight.pop(token);
+      record_error();
+    }
+    read_items.close();
+  });
+
+  std::thread writer([&]() {
+    std::map<std::size_t, std::shared_ptr<Sequenced>> early_items;
+    std::size_t next_rank = 0;
+    bool token;
+    auto write_item = [&](Sequenced& sequenced) {
+      if (sequenced.ok) {
+        try {
+          write(sequenced.item);
+        }
+        catch (...) {
+          record_error();
+        }
+      }
+      in_flight.pop(token);
+    };
+
+    std::shared_ptr<Sequenced> sequenced;
+    while (processed_items.pop(sequenced)) {
+      if (!ordered) {
+        write_item(*sequenced);
+        continue;
+      }
+      early_items[sequenced->rank] = std::move(sequenced);
+      for (auto next = early_items.find(next_rank); next != early_items.end();
+           next = early_items.find(++next_rank)) {
+        write_item(*next->second);
+        early_items.erase(next);
+      }
+    }
+  });
+
+  std::shared_ptr<Sequenced> sequenced;
+  while (read_items.pop(sequenced)) {
+    scheduler.spawn([&, sequenced]() {
+      try {
+        process(sequenced->item);
+      }
+      catch (...) {
+        sequenced->ok = false;
+        record_error();
+      }
+      processed_items.push(sequenced);
+    });
+  }
+  scheduler.wait();
+  processed_items.close();
+  writer.join();
+  reader.join();
+
+  if (error) std::rethrow_exception(error);
+}
+
+}  // namespace LTL2PROP
+
+#endif  // PIPELINE_HPP_
@@ -0,0 +1,183 @@
+#ifndef TASKSCHEDULER_HPP_
+#define TASKSCHEDULER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LTL2PROP {
+
+/**
+ * @brief Pool of worker threads sharing tasks by work stealing
+ *
+ * Each worker has its own queue. A task spawned by a worker goes to the back
+ * of the worker's queue, where the worker takes its next task; an idle worker
+ * steals from the front of the other queues, so the oldest and usually
+ * largest tasks move to idle threads while the owners work on the recent
+ * ones. Tasks spawned from another thread are dealt to the queues in turn.
+ */
+class TaskScheduler {
+ public:
+  typedef std::function<void()> Task;
+
+  /**
+   * Start the worker threads
+   *
+   * @param workers number of worker threads, at least one
+   */
+  explicit TaskScheduler(unsigned workers);
+
+  /**
+   * Run the queued tasks and stop the worker threads
+   */
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  /**
+   * Get the number of worker threads
+   *
+   * @return number of workers
+   */
+  unsigned worker_count() const;
+
+  /**
+   * Queue a task
+   *
+   * @param task task to be run by a worker
+   */
+  void spawn(Task task);
+
+  /**
+   * Wait until every spawned task has run, from a thread that isn't a worker
+   *
+   * @throws the first exception thrown by a task
+   */
+  void wait();
+
+  /**
+   * Get the worker running the calling thread
+   *
+   * @return index of the worker, -1 outside of the workers of any scheduler
+   */
+  static int current_worker();
+
+ private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /**
+   * Take a task from the back of a worker's own queue
+   *
+   * @param worker index of the worker
+   * @param task set to the task taken
+   * @return true if a task was taken, false if the queue is empty
+   */
+  bool pop(unsigned worker, Task& task);
+
+  /**
+   * Take a task from the front of the queue of another worker
+   *
+   * @param thief index of the idle worker
+   * @param task set to the task taken
+   * @return true if a task was stolen, false if every queue is empty
+   */
+  bool steal(unsigned thief, Task& task);
+
+  /**
+   * Main loop of a worker thread
+   *
+   * @param worker index of the worker
+   */
+  void run(unsigned worker);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  std::vector<std::thread> threads;
+
+  // tasks in the queues, may be briefly negative while a task is being spawned
+  std::atomic<long> queued{0};
+  // tasks spawned and not finished yet
+  std::atomic<std::size_t> pending{0};
+  // queue receiving the next task spawned outside of the workers
+  std::atomic<unsigned> next_queue{0};
+
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  std::condition_variable idle;
+  bool stopping = false;
+  std::exception_ptr error;
+};
+
+/**
+ * @brief Subtasks of a task, waited for together
+ *
+ * While it waits, the spawning thread runs the subtasks no worker has stolen
+ * yet, so a task splitting its work never leaves its own thread idle and
+ * never runs unrelated tasks in the middle of its work.
+ */
+class TaskGroup {
+ public:
+  /**
+   * Create an empty group
+   *
+   * @param scheduler scheduler whose workers may steal the subtasks
+   */
+  explicit TaskGroup(TaskScheduler& scheduler);
+
+  /**
+   * Drop the subtasks not started yet and wait for the running ones
+   */
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  /**
+   * Add a subtask to the group
+   *
+   * @param task subtask
+   */
+  void spawn(TaskScheduler::Task task);
+
+  /**
+   * Run or wait for every subtask of the group
+   *
+   * @throws the first exception thrown by a subtask
+   */
+  void wait();
+
+ private:
+  struct State {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::deque<TaskScheduler::Task> tasks;
+    std::size_t running = 0;
+    std::exception_ptr error;
+  };
+
+  /**
+   * Run a subtask not started yet, if any
+   *
+   * @param state state of the group
+   * @param newest take the last subtask spawned instead of the first one
+   * @return true if a subtask was run, false if none was left
+   */
+  static bool run_one(const std::shared_ptr<State>& state, bool newest);
+
+  TaskScheduler& scheduler;
+  std::shared_ptr<State> state;
+};
+
+}  // namespace LTL2PROP
+
+#endif  // TASKSCHEDULER_HPP_
@@ -0,0 +1,86 @@
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+
+#include <chrono>
+#include <string>
+
+namespace LTL2PROP {
+
+/**
+ * @brief Recording of timed spans, saved in Chrome trace-event format
+ *
+ * Spans are only recorded while a session is open. The trace can be opened
+ * in chrome://tracing or in Perfetto.
+ */
+class TraceSession {
+ public:
+  /**
+   * Start recording spans
+   *
+   * @param filename path to the trace file written when the session ends
+   */
+  explicit TraceSession(const std::string& filename);
+
+  /**
+   * Stop recording spans and write the trace file
+   */
+  ~TraceSession();
+
+  TraceSession(const TraceSession&) = delete;
+  TraceSession& operator=(const TraceSession&) = delete;
+
+  /**
+   * Check if spans are being recorded
+   *
+   * @return true if a session is open, false otherwise
+   */
+  static bool is_recording();
+
+ private:
+  // path to the trace file
+  std::string filename;
+};
+
+/**
+ * @brief Span recorded from its construction to its destruction
+ */
+class TraceSpan {
+ public:
+  /**
+   * Start a span
+   *
+   * @param name name of the span, a string literal or __func__
+   * @param category category of the span (load, index, query, template, write)
+   * @param detail optional detail shown with the span, such as a file name
+   */
+  TraceSpan(const char* name, const char* category, const std::string& detail = "");
+
+  /**
+   * End the span and record it
+   */
+  ~TraceSpan();
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  const char* name;
+  const char* category;
+  std::string detail;
+  bool recording;
+  std::chrono::steady_clock::time_point begin;
+};
+
+}  // namespace LTL2PROP
+
+// spans compile out unless the build enables LTL2PROP_ENABLE_TRACING
+#ifdef LTL2PROP_ENABLE_TRACING
+#define LTL2PROP_TRACE_CONCAT_(a, b) a##b
+#define LTL2PROP_TRACE_CONCAT(a, b) LTL2PROP_TRACE_CONCAT_(a, b)
+#define LTL2PROP_TRACE_SCOPE(...) \
+  ::LTL2PROP::TraceSpan LTL2PROP_TRACE_CONCAT(trace_span_, __LINE__)(__VA_ARGS__)
+#else
+#define LTL2PROP_TRACE_SCOPE(...)
+#endif
+
+#endif  // TRACE_HPP_
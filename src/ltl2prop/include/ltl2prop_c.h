@@ -0,0 +1,151 @@
+#ifndef LTL2PROP_C_H_
+#define LTL2PROP_C_H_
+
+/**
+ * @file ltl2prop_c.h
+ * @brief C API of the ltl2prop shared library
+ *
+ * A net is loaded once and translated against many formulas, the queries
+ * answered for a formula are reused by the next ones:
+ * \code{.c}
+ * ltl2prop_net* net;
+ * ltl2prop_result* result;
+ * if (ltl2prop_net_load_file("Bank.lna.json", &net) == LTL2PROP_OK) {
+ *   if (ltl2prop_translate(net, formula, formula_size, &result) == LTL2PROP_OK) {
+ *     size_t size;
+ *     const char* property = ltl2prop_result_property(result, &size);
+ *     ...
+ *     ltl2prop_result_free(result);
+ *   }
+ *   ltl2prop_net_free(net);
+ * }
+ * \endcode
+ *
+ * Functions return a status; the message of the last error of the calling
+ * thread is given by ltl2prop_last_error(). A net must not be used by two
+ * threads at once, results are independent of their net.
+ */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#  if defined(LTL2PROP_C_API_EXPORTS)
+#    define LTL2PROP_C_API __declspec(dllexport)
+#  else
+#    define LTL2PROP_C_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define LTL2PROP_C_API __attribute__((visibility("default")))
+#else
+#  define LTL2PROP_C_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** version of the C API, increased when a function changes */
+#define LTL2PROP_C_API_VERSION 1
+
+/** status returned by the functions of the C API */
+typedef enum ltl2prop_status {
+  LTL2PROP_OK = 0,
+  /** a required argument is NULL */
+  LTL2PROP_INVALID_ARGUMENT = 1,
+  /** the lna-info cannot be read or parsed */
+  LTL2PROP_NET_ERROR = 2,
+  /** the formula cannot be parsed or translated */
+  LTL2PROP_TRANSLATION_ERROR = 3
+} ltl2prop_status;
+
+/** net loaded from an lna-info, with the query results of its translations */
+typedef struct ltl2prop_net ltl2prop_net;
+
+/** property and propositions of a translated formula */
+typedef struct ltl2prop_result ltl2prop_result;
+
+/**
+ * Get the version of the C API the library implements
+ *
+ * @return LTL2PROP_C_API_VERSION of the library
+ */
+LTL2PROP_C_API int ltl2prop_api_version(void);
+
+/**
+ * Get the message of the last error of the calling thread
+ *
+ * @return message, empty if no error occurred; valid until the next call
+ * failing in the same thread
+ */
+LTL2PROP_C_API const char* ltl2prop_last_error(void);
+
+/**
+ * Load a net from an lna-info file or a shard manifest
+ *
+ * @param path path to the file, NUL-terminated
+ * @param net set to the loaded net, to be released by ltl2prop_net_free()
+ * @return LTL2PROP_OK, or the reason of the failure
+ */
+LTL2PROP_C_API ltl2prop_status ltl2prop_net_load_file(const char* path, ltl2prop_net** net);
+
+/**
+ * Load a net from an lna-info JSON text
+ *
+ * @param data JSON text, not necessarily NUL-terminated
+ * @param size length of the text in bytes
+ * @param net set to the loaded net, to be released by ltl2prop_net_free()
+ * @return LTL2PROP_OK, or the reason of the failure
+ */
+LTL2PROP_C_API ltl2prop_status ltl2prop_net_load_buffer(const char* data, size_t size, ltl2prop_net** net);
+
+/**
+ * Release a net
+ *
+ * @param net net to be released, may be NULL
+ */
+LTL2PROP_C_API void ltl2prop_net_free(ltl2prop_net* net);
+
+/**
+ * Translate an LTL formula against a net
+ *
+ * @param net the net
+ * @param formula JSON text of the formula, not necessarily NUL-terminated
+ * @param size length of the formula in bytes
+ * @param result set to the translation, to be released by ltl2prop_result_free()
+ * @return LTL2PROP_OK, or the reason of the failure
+ */
+LTL2PROP_C_API ltl2prop_status ltl2prop_translate(ltl2prop_net* net, const char* formula, size_t size,
+                                                  ltl2prop_result** result);
+
+/**
+ * Get the Helena property of a translation
+ *
+ * @param result the translation
+ * @param size set to the length of the property in bytes, may be NULL
+ * @return property, NUL-terminated, owned by the result; NULL with a size of
+ * 0 if result is NULL
+ */
+LTL2PROP_C_API const char* ltl2prop_result_property(const ltl2prop_result* result, size_t* size);
+
+/**
+ * Get the Helena propositions of a translation
+ *
+ * @param result the translation
+ * @param size set to the length of the propositions in bytes, may be NULL
+ * @return propositions, NUL-terminated, owned by the result; NULL with a size of
+ * 0 if result is NULL
+ */
+LTL2PROP_C_API const char* ltl2prop_result_propositions(const ltl2prop_result* result, size_t* size);
+
+/**
+ * Release a translation
+ *
+ * @param result translation to be released, may be NULL
+ */
+LTL2PROP_C_API void ltl2prop_result_free(ltl2prop_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* LTL2PROP_C_H_ */
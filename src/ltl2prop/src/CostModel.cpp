@@ -0,0 +1,154 @@
+#include "CostModel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include "LtlFormula.hpp"
+#include "json.hpp"
+
+namespace LTL2PROP {
+
+  namespace {
+
+  // largest automaton bound reported, 2^30
+  const int max_automaton_exponent = 30;
+
+  /**
+   * @brief Evaluation cost of a proposition, from its shape
+   */
+  struct PropositionCost {
+    // operations per evaluation
+    double cost = 0;
+    // largest number of quantified places that may hold more than one token
+    int degree = 0;
+  };
+
+  // comparisons of a condition: <, >, <=, >=, =, != but not the -> of tokens
+  int comparisons(const std::string& condition) {
+    int count = 0;
+    for (std::size_t i = 0; i < condition.size(); ++i) {
+      char c = condition[i];
+      if (c == '>' && i > 0 && condition[i - 1] == '-') continue;
+      if (c == '<' || c == '>' || c == '!' || c == '=') {
+        ++count;
+        if (i + 1 < condition.size() && condition[i + 1] == '=') ++i;
+      }
+    }
+    return count;
+  }
+
+  std::string complexity(int degree) {
+    if (degree == 0) return "O(1)";
+    if (degree == 1) return "O(n)";
+    return "O(n^" + std::to_string(degree) + ")";
+  }
+
+  PropositionCost proposition_cost(const Proposition& proposition, const CostModel& model) {
+    PropositionCost cost;
+    for (const auto& quantification : proposition.quantifications) {
+      double tokens = 1;
+      int degree = 0;
+      for (const auto& place : quantification.places) {
+        tokens *= model.bound(place);
+        if (model.bound(place) > 1) ++degree;
+      }
+      cost.cost += tokens * std::max(1, comparisons(quantification.condition));
+      cost.degree = std::max(cost.degree, degree);
+    }
+    cost.cost += proposition.places.size();
+    return cost;
+  }
+
+  /**
+   * @brief Shape of an LTL formula
+   */
+  struct FormulaShape {
+    std::set<std::string> atoms;
+    int temporal_operators = 0;
+    int temporal_depth = 0;
+  };
+
+  void formula_shape(const LtlFormula& formula, int depth, FormulaShape& shape) {
+    if (formula.kind == LtlFormula::Atom) shape.atoms.insert(formula.atom);
+    if (formula.kind == LtlFormula::Always || formula.kind == LtlFormula::Eventually ||
+        formula.kind == LtlFormula::Until) {
+      ++shape.temporal_operators;
+      ++depth;
+    }
+    shape.temporal_depth = std::max(shape.temporal_depth, depth);
+    for (const auto& operand : formula.operands) formula_shape(operand, depth, shape);
+  }
+
+  }  // namespace
+
+  double CostModel::bound(const std::string& place) const {
+    auto place_bound = place_bounds.find(place);
+    return place_bound == place_bounds.end() ? token_bound : place_bound->second;
+  }
+
+  nlohmann::json cost_report(const std::map<std::string, std::string>& translation,
+                             const CostModel& model) {
+    auto property_text = translation.find("property");
+    auto propositions_text = translation.find("propositions");
+
+    // the formula tells which propositions are evaluated
+    nlohmann::json report = {{"property", nullptr}, {"formula", nullptr}, {"token_bound", model.token_bound}};
+    FormulaShape shape;
+    bool parsed = false;
+    if (property_text != translation.end()) {
+      try {
+        LtlProperty property = parse_ltl_property(property_text->second);
+        formula_shape(property.formula, 0, shape);
+        int exponent = std::min(shape.temporal_operators, max_automaton_exponent);
+        report["property"] = property.name;
+        report["formula"] = {
+          {"atoms", shape.atoms.size()},
+          {"temporal_operators", shape.temporal_operators},
+          {"temporal_depth", shape.temporal_depth},
+          {"automaton_states_bound", std::pow(2.0, exponent)},
+        };
+        parsed = true;
+      }
+      catch (const std::runtime_error&) {
+        // properties that cannot be parsed are costed on their propositions only
+      }
+    }
+
+    // propositions: <name> : <expression>; one per line
+    nlohmann::json propositions = nlohmann::json::array();
+    double per_state_cost = 0;
+    int degree = 0;
+    for (const auto& proposition : parse_propositions(
+             propositions_text == translation.end() ? "" : propositions_text->second)) {
+      PropositionCost cost = proposition_cost(proposition, model);
+      bool used = !parsed || shape.atoms.count(proposition.name) > 0;
+      if (used) {
+        per_state_cost += cost.cost;
+        degree = std::max(degree, cost.degree);
+      }
+      std::vector<std::vector<std::string>> quantified_places;
+      for (const auto& quantification : proposition.quantifications) {
+        quantified_places.push_back(quantification.places);
+      }
+      propositions.push_back({
+        {"name", proposition.name},
+        {"kind", proposition.kind()},
+        {"places", proposition.places},
+        {"quantified_places", quantified_places},
+        {"cost", cost.cost},
+        {"complexity", complexity(cost.degree)},
+        {"used", used},
+      });
+    }
+
+    double automaton_states = parsed ? report["formula"]["automaton_states_bound"].get<double>() : 1;
+    report["propositions"] = propositions;
+    report["per_state_cost"] = per_state_cost;
+    report["complexity"] = complexity(degree);
+    report["estimated_cost"] = per_state_cost * automaton_states;
+    return report;
+  }
+
+}  // namespace LTL2PROP
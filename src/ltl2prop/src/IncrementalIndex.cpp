@@ -0,0 +1,242 @@
+#include "IncrementalIndex.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <initializer_list>
+#include <utility>
+#include "LTLtranslator.hpp"
+#include "json.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define LTL2PROP_HAS_GETPID 1
+#endif
+
+namespace LTL2PROP {
+
+  namespace {
+
+  const std::uint64_t fnv_offset_basis = 14695981039346656037ULL;
+  const std::uint64_t fnv_prime = 1099511628211ULL;
+
+  std::uint64_t fnv1a(const std::string& content, std::uint64_t hash = fnv_offset_basis) {
+    for (unsigned char byte : content) {
+      hash ^= byte;
+      hash *= fnv_prime;
+    }
+    return hash;
+  }
+
+  std::string to_hex(std::uint64_t hash) {
+    char digest[17];
+    std::snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(hash));
+    return digest;
+  }
+
+  // serialized fields, separated by a byte that cannot occur in names
+  std::string serialize(std::initializer_list<std::string> fields) {
+    std::string content;
+    for (const auto& field : fields) {
+      content += field;
+      content += '\x1f';
+    }
+    return content;
+  }
+
+  }  // namespace
+
+  std::string content_hash(const std::string& content) {
+    return to_hex(fnv1a(content));
+  }
+
+  std::string content_hash(const char* begin, const char* end) {
+    std::uint64_t hash = fnv_offset_basis;
+    for (const char* byte = begin; byte != end; ++byte) {
+      hash ^= static_cast<unsigned char>(*byte);
+      hash *= fnv_prime;
+    }
+    return to_hex(hash);
+  }
+
+  std::string file_hash(const std::string& filename) {
+    std::ifstream file_stream(filename, std::ios::binary);
+    if (!file_stream) return "";
+    std::uint64_t hash = fnv_offset_basis;
+    char buffer[1 << 16];
+    while (file_stream.read(buffer, sizeof(buffer)) || file_stream.gcount() > 0) {
+      for (std::streamsize i = 0; i < file_stream.gcount(); ++i) {
+        hash ^= static_cast<unsigned char>(buffer[i]);
+        hash *= fnv_prime;
+      }
+    }
+    return to_hex(hash);
+  }
+
+  std::map<std::string, std::string> net_digests(const Net& net) {
+    // running hashes, each statement is folded into every part it belongs to
+    std::map<std::string, std::uint64_t> hashes;
+    auto fold = [&hashes](const std::string& key, const std::string& content) {
+      auto hash = hashes.emplace(key, fnv_offset_basis).first;
+      hash->second = fnv1a(content, hash->second);
+    };
+
+    std::string variables;
+    for (const auto& global_variable : net.global_variables) {
+      variables += serialize({"global", global_variable});
+    }
+    for (const auto& local_variable : net.local_variables) {
+      variables += serialize({"local", local_variable.smart_contract, local_variable.function,
+                              local_variable.name, local_variable.place});
+    }
+    for (const auto& place_capacity : net.place_capacities) {
+      variables += serialize({"place", place_capacity.first, std::to_string(place_capacity.second)});
+    }
+    fold("variables", variables);
+    fold("*", variables);
+
+    std::string entry_points;
+    for (const auto& entry_point : net.entry_points) {
+      entry_points += serialize({"entry", entry_point});
+    }
+    fold("calls", entry_points);
+    fold("*", entry_points);
+
+    // functions defined by each smart contract, which resolve the callees
+    std::set<std::pair<std::string, std::string>> definitions;
+    for (const auto& statement : net.statements) {
+      if (!statement.parent.empty()) definitions.emplace(statement.smart_contract, statement.parent);
+      std::string content = serialize({statement.type, statement.smart_contract, statement.parent,
+                                       statement.variable, statement.function_name,
+                                       statement.input_place, statement.output_place,
+                                       statement.param_place, statement.timestamp ? "1" : "0"});
+      for (const auto& RHVariable : statement.RHV) {
+        content += serialize({RHVariable});
+      }
+      content += '\n';
+
+      fold("*", content);
+      if (statement.type == "function_call") fold("calls", content);
+      fold("function:" + statement.smart_contract + "::" + statement.parent, content);
+      if (statement.function_name != statement.parent) {
+        fold("function:" + statement.smart_contract + "::" + statement.function_name, content);
+      }
+
+      std::set<std::string> variable_names(statement.RHV.begin(), statement.RHV.end());
+      variable_names.insert(statement.variable);
+      for (const auto& variable_name : variable_names) {
+        if (!variable_name.empty()) fold("variable:" + variable_name, content);
+      }
+    }
+
+    std::string defined_functions;
+    for (const auto& definition : definitions) {
+      defined_functions += serialize({"defined", definition.first, definition.second});
+    }
+    fold("definitions", defined_functions);
+
+    std::map<std::string, std::string> digests;
+    for (const auto& hash : hashes) {
+      digests[hash.first] = to_hex(hash.second);
+    }
+    return digests;
+  }
+
+  IncrementalIndex::IncrementalIndex(const std::string& _filename)
+      : filename(_filename), properties(nlohmann::json::object()) {
+    std::ifstream index_stream(filename);
+    if (!index_stream) return;
+    nlohmann::json index = nlohmann::json::parse(index_stream, nullptr, false);
+    if (index.is_object() && index.contains("properties")) {
+      properties = index.at("properties");
+    }
+  }
+
+  bool IncrementalIndex::is_up_to_date(const std::string& name, const std::string& formula_hash,
+                                       const std::map<std::string, std::string>& digests,
+                                       const std::map<std::string, std::string>& files) const {
+    auto property = properties.find(name);
+    if (property == properties.end() || property->value("formula", "") != formula_hash ||
+        property->value("translation", 0u) != translation_version) {
+      return false;
+    }
+
+    // a part missing from the net has no digest, which differs from any recorded one
+    for (const auto& dependency : property->at("dependencies").items()) {
+      auto digest = digests.find(dependency.key());
+      std::string current = digest == digests.end() ? "" : digest->second;
+      if (current != dependency.value().get<std::string>()) return false;
+    }
+
+    // an output written over since, such as a net generated again, must be written again
+    const nlohmann::json& recorded_files = property->value("files", nlohmann::json::object());
+    for (const auto& file : files) {
+      auto recorded = recorded_files.find(file.first);
+      if (file.second.empty() || recorded == recorded_files.end() || recorded->get<std::string>() != file.second) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::string IncrementalIndex::propositions(const std::string& name) const {
+    auto property = properties.find(name);
+    return property == properties.end() ? "" : property->value("propositions", "");
+  }
+
+  Verdict IncrementalIndex::verdict(const std::string& name) const {
+    auto property = properties.find(name);
+    if (property == properties.end()) return Verdict::Undecided;
+    std::string recorded = property->value("verdict", "");
+    return recorded == "holds" ? Verdict::Holds : recorded == "violated" ? Verdict::Violated : Verdict::Undecided;
+  }
+
+  void IncrementalIndex::update(const std::string& name, const std::string& formula_hash,
+                                const std::set<std::string>& dependencies,
+                                const std::map<std::string, std::string>& digests,
+                                const std::string& propositions,
+                                const std::map<std::string, std::string>& files,
+                                Verdict verdict) {
+    nlohmann::json recorded_dependencies = nlohmann::json::object();
+    for (const auto& dependency : dependencies) {
+      auto digest = digests.find(dependency);
+      recorded_dependencies[dependency] = digest == digests.end() ? "" : digest->second;
+    }
+    properties[name] = {
+      {"formula", formula_hash},
+      {"translation", translation_version},
+      {"dependencies", recorded_dependencies},
+      {"propositions", propositions},
+      {"files", files},
+    };
+    if (verdict != Verdict::Undecided) {
+      properties[name]["verdict"] = verdict == Verdict::Holds ? "holds" : "violated";
+    }
+  }
+
+  void IncrementalIndex::update_files(const std::string& name, const std::map<std::string, std::string>& files) {
+    auto property = properties.find(name);
+    if (property != properties.end()) (*property)["files"] = files;
+  }
+
+  void IncrementalIndex::save() const {
+    nlohmann::json index = {{"properties", properties}};
+#ifdef LTL2PROP_HAS_GETPID
+    std::string temporary = filename + ".tmp." + std::to_string(::getpid());
+#else
+    std::string temporary = filename + ".tmp";
+#endif
+    {
+      std::ofstream index_stream(temporary);
+      index_stream << index.dump(2) << std::endl;
+      index_stream.close();
+      if (index_stream.fail()) {
+        std::remove(temporary.c_str());
+        return;
+      }
+    }
+    // the previous index is kept until the new one is complete
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) std::remove(temporary.c_str());
+  }
+
+}  // namespace LTL2PROP
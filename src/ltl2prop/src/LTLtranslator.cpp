@@ -1,11 +1,17 @@
 #include "LTLtranslator.hpp"
 
 #include <stddef.h>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
 #include "json.hpp"
+#include "MemoryStats.hpp"
+#include "Trace.hpp"
 
 
 namespace LTL2PROP {
@@ -13,7 +19,12 @@ namespace LTL2PROP {
   LTLTranslator::LTLTranslator(const nlohmann::json& lna_json,
                               const nlohmann::json& ltl_json) {
     formula_json = ltl_json;
-    handleVariable(lna_json);
+    handleVariable(net_from_json(lna_json));
+  }
+
+  LTLTranslator::LTLTranslator(const Net& net, const nlohmann::json& ltl_json) {
+    formula_json = ltl_json;
+    handleVariable(net);
   }
 
   LTLTranslator::vulnerabilities LTLTranslator::getVulnerability(std::string vulnerability){
@@ -23,6 +34,7 @@ namespace LTL2PROP {
     if (vulnerability == "Skip Empty String Literal") return SkipEmptyStringLiteral;
     if (vulnerability == "Uninitialized Storage Variable") return UninitializedStorageVariable;
     if (vulnerability == "Self Destruction") return SelfDestruction;
+    throw std::runtime_error("formula type " + vulnerability + " is not handled by LTLTranslator");
   }
   
   LTLTranslator::propertyTemplates LTLTranslator::getPropertyTemplate(std::string propertyTemplate){
@@ -36,407 +48,796 @@ namespace LTL2PROP {
     if (propertyTemplate == "Sequential Execution") return SequentialExecution;
     if (propertyTemplate == "Function A Call Followed by Function B Execution") return CallFollowedByExec;
     if (propertyTemplate == "Function A Execution Followed by Function B Call") return ExecFollowedByCall;
+    throw std::runtime_error("formula type " + propertyTemplate + " is not handled by LTLTranslator");
   }
 
-  void LTLTranslator::handleVariable(const nlohmann::json& lna_json) {
-    // get global variables
-    for (const auto& global_var : lna_json.at("global_variables")) {
-      global_variables.push_back(global_var.at("name"));
-    }
-
-    // get local variables from functions
-    for (const auto& function : lna_json.at("functions")) {
-      for (const auto& local_var : function.at("local_variables")) {
-        local_variables[local_var.at("name")] = local_var.at("place");
+  void LTLTranslator::handleVariable(const Net& net) {
+    LTL2PROP_TRACE_SCOPE(__func__, "index");
+    LTL2PROP_MEMORY_PHASE(StatementStore);
+    global_variables.insert(net.global_variables.begin(), net.global_variables.end());
+    place_capacities = net.place_capacities;
+
+    // local variables are looked up in the scope of their function, or by
+    // name when their name is declared in a single place
+    for (const auto& local_var : net.local_variables) {
+      local_variables[scoped_variable_name(local_var.smart_contract, local_var.function, local_var.name)] = local_var.place;
+      auto unscoped = unscoped_local_variables.emplace(local_var.name, local_var.place);
+      if (!unscoped.second && unscoped.first->second != local_var.place) {
+        ambiguous_local_variables.insert(local_var.name);
       }
     }
 
-    statement_list = lna_json.at("statements");
     // get statements
-    for (const auto& statement : statement_list) {
-      Statement s = {
-        .type = statement.at("type"),
-        .smart_contract = statement.at("smart_contract"),
-        .parent = statement.at("parent"),
-        .variable = statement.at("variable"),
-        .function_name = statement.at("function"),
-        .input_place = statement.at("input_place"),
-        .output_place = statement.at("output_place"),
-        .param_place = statement.at("param_place"),
-        .RHV = statement["right_hand_variables"].get<std::list<std::string>>(),
-        .timestamp = statement.at("timestamp"),
-      };
-      
+    std::shared_ptr<StatementStore> store = std::make_shared<StatementStore>();
+    for (const auto& s : net.statements) {
       // assign statements to their respective lists
-      if (s.type=="assignment") assignments.push_back(s);
-      if (s.type=="selection") selections.push_back(s);
-      if (s.type=="sending") sendings.push_back(s);
-      if (s.type=="function_call") function_calls.push_back(s);
-      if (s.type=="variable_declaration") variable_declarations.push_back(s);
-      if (s.type=="return") returnings.push_back(s);
-      if (s.type=="require") requirements.push_back(s);
-      if (s.type=="for_loop") for_loops.push_back(s);
-      if (s.type=="while_loop") while_loops.push_back(s);
-      
+      if (s.type=="assignment") store->assignments.push_back(s);
+      if (s.type=="selection") store->selections.push_back(s);
+      if (s.type=="sending") store->sendings.push_back(s);
+      if (s.type=="function_call") store->function_calls.push_back(s);
+      if (s.type=="variable_declaration") store->variable_declarations.push_back(s);
+      if (s.type=="return") store->returnings.push_back(s);
+      if (s.type=="require") store->requirements.push_back(s);
+      if (s.type=="for_loop") store->for_loops.push_back(s);
+      if (s.type=="while_loop") store->while_loops.push_back(s);
+
+      // record def-use edges from each right hand variable to the defined one
+      if ((s.type=="assignment" || s.type=="variable_declaration") && !s.variable.empty()) {
+        DefUseEdges& edges = store->def_use_graph[s.parent][s.smart_contract];
+        for (const auto& RHVariable : s.RHV) {
+          edges[RHVariable].push_back(s.variable);
+        }
+      }
+
+      // record call edges from the caller to the callee
+      if (s.type=="function_call") {
+        store->call_graph[s.parent].push_back(s.function_name);
+      }
+    }
+
+    // functions defined by each smart contract, which resolve the callees
+    std::unordered_map<std::string, std::set<std::string>> defining_contracts;
+    for (const auto& s : net.statements) {
+      if (!s.parent.empty()) defining_contracts[s.parent].insert(s.smart_contract);
+    }
+    for (const auto& call : store->function_calls) {
+      auto contracts = defining_contracts.find(call.function_name);
+      if (contracts == defining_contracts.end()) continue;
+      std::vector<FunctionScope>& call_callees = store->callees[FunctionScope(call.smart_contract, call.parent)];
+      if (contracts->second.count(call.smart_contract) > 0) {
+        call_callees.push_back(FunctionScope(call.smart_contract, call.function_name));
+        continue;
+      }
+      for (const auto& contract : contracts->second) {
+        call_callees.push_back(FunctionScope(contract, call.function_name));
+      }
     }
 
+    // strongly connected components of the call graph (Tarjan), so that the
+    // functions of a cycle of calls share their closure
+    std::map<FunctionScope, std::size_t> call_indices, call_lowlinks;
+    std::vector<FunctionScope> component_stack;
+    std::set<FunctionScope> on_component_stack;
+    std::size_t next_index = 0, component_count = 0;
+    for (const auto& root : store->callees) {
+      if (call_indices.count(root.first) > 0) continue;
+      // depth-first walk without recursion: functions with their next callee
+      std::vector<std::pair<FunctionScope, std::size_t>> walk = {{root.first, 0}};
+      while (!walk.empty()) {
+        const FunctionScope caller = walk.back().first;
+        std::size_t& next_callee = walk.back().second;
+        if (next_callee == 0 && call_indices.emplace(caller, next_index).second) {
+          call_lowlinks[caller] = next_index++;
+          component_stack.push_back(caller);
+          on_component_stack.insert(caller);
+        }
+        auto caller_callees = store->callees.find(caller);
+        if (caller_callees != store->callees.end() && next_callee < caller_callees->second.size()) {
+          const FunctionScope& callee = caller_callees->second[next_callee++];
+          if (call_indices.count(callee) == 0) {
+            walk.push_back({callee, 0});
+          }
+          else if (on_component_stack.count(callee) > 0) {
+            call_lowlinks[caller] = std::min(call_lowlinks[caller], call_indices[callee]);
+          }
+          continue;
+        }
+        // every callee is visited: the caller roots a component or joins its caller's
+        if (call_lowlinks[caller] == call_indices[caller]) {
+          FunctionScope member;
+          do {
+            member = component_stack.back();
+            component_stack.pop_back();
+            on_component_stack.erase(member);
+            store->call_components[member] = component_count;
+          } while (member != caller);
+          ++component_count;
+        }
+        walk.pop_back();
+        if (!walk.empty()) {
+          std::size_t& parent_lowlink = call_lowlinks[walk.back().first];
+          parent_lowlink = std::min(parent_lowlink, call_lowlinks[caller]);
+        }
+      }
+    }
+
+    // functions reachable from the entry points; without entry points, any
+    // function may be called by a transaction and none is pruned
+    store->has_entry_points = !net.entry_points.empty();
+    std::vector<std::string> worklist(net.entry_points.begin(), net.entry_points.end());
+    store->reachable_functions.insert(worklist.begin(), worklist.end());
+    while (!worklist.empty()) {
+      std::string caller = worklist.back();
+      worklist.pop_back();
+      auto callees = store->call_graph.find(caller);
+      if (callees == store->call_graph.end()) continue;
+      for (const auto& callee : callees->second) {
+        if (store->reachable_functions.insert(callee).second) worklist.push_back(callee);
+      }
+    }
+    statement_store = store;
+
+    // ranges small enough to balance the subtasks, large enough to amortize them
+    const std::size_t range_size = 4096;
+    for (const auto& statement_list : statement_lists()) {
+      auto begin = statement_list.second->begin();
+      while (begin != statement_list.second->end()) {
+        auto end = begin;
+        for (std::size_t i = 0; i < range_size && end != statement_list.second->end(); ++i) ++end;
+        store->ranges.push_back({statement_list.first, begin, end});
+        begin = end;
+      }
+    }
+  }
+
+  void LTLTranslator::set_scheduler(TaskScheduler* _scheduler) {
+    scheduler = _scheduler;
   }
 
   bool LTLTranslator::is_global_variable(const std::string& _name) const {
-    return (std::find(global_variables.begin(), global_variables.end(), _name) != global_variables.end());
+    return global_variables.find(_name) != global_variables.end();
   }
 
   bool LTLTranslator::is_local_variable(const std::string& _name) const {
-    return local_variables.find(_name) != local_variables.end();
+    return unscoped_local_variables.find(_name) != unscoped_local_variables.end();
   }
 
-  std::string LTLTranslator::get_local_variable_placetype(
-      const std::string& _name) {
-    return is_local_variable(_name) ? local_variables[_name] : "";
+  std::string LTLTranslator::scoped_variable_name(const std::string& _smart_contract, const std::string& _function,
+                                                  const std::string& _name) {
+    return _smart_contract + "::" + _function + "::" + _name;
   }
 
-  std::list<std::string> LTLTranslator::get_sending_output_places(std::string function, std::string smart_contract){
-    std::list<std::string> sending_output_places;
-    for (const auto& sending: sendings) {
-      if (sending.parent == function && sending.smart_contract == smart_contract && !sending.output_place.empty()){
-           sending_output_places.push_back(sending.output_place);
-        }
-      } 
-    if(sending_output_places.empty()){
-      std::runtime_error("There are no sending statements in this smart contract");
+  std::string LTLTranslator::get_variable_place(const std::string& _name, const std::string& _function,
+                                                const std::string& _smart_contract) const {
+    // locals of the function shadow the globals
+    if (!_function.empty()) {
+      auto local = local_variables.find(scoped_variable_name(_smart_contract, _function, _name));
+      if (local != local_variables.end()) return local->second;
     }
-    sending_output_places.unique();
-    return sending_output_places;     
+    if (is_global_variable(_name)) return "S";
+    if (!_function.empty()) {
+      throw std::runtime_error("Variable " + _name + " is neither a local variable of " + _smart_contract + "." +
+                               _function + " nor a global variable.");
+    }
+
+    auto unscoped = unscoped_local_variables.find(_name);
+    if (unscoped == unscoped_local_variables.end()) {
+      throw std::runtime_error("Variable " + _name + " doesn't exist in smart contract.");
+    }
+    if (ambiguous_local_variables.count(_name) > 0) {
+      throw std::runtime_error("Variable " + _name + " is declared by several functions, its function and smart contract must be selected.");
+    }
+    return unscoped->second;
   }
 
+  bool LTLTranslator::is_singleton_place(const std::string& _place) const {
+    auto capacity = place_capacities.find(_place);
+    return _place == "S" || (capacity != place_capacities.end() && capacity->second == 1);
+  }
 
-  std::list<std::string> LTLTranslator::get_selection_output_places(std::string variable,std::string function, std::string smart_contract){
-    std::list<std::string> selection_output_places;
-    for (const auto& selection: selections) {
-      if(selection.smart_contract == smart_contract && selection.parent == function && !selection.output_place.empty()){
-        if (selection.variable == variable){
-            selection_output_places.push_back(selection.output_place);
-        }
-        else if(!selection.RHV.empty()){
-          for (auto &RHVariable : selection.RHV){
-            if(RHVariable == variable){
-              selection_output_places.push_back(selection.output_place);
-            }
-          }
-        }
-      } 
+  std::string LTLTranslator::get_variable_comparison(const std::string& variable, const std::string& comparison,
+                                                     const std::string& rival_variable, const std::string& function,
+                                                     const std::string& smart_contract) const {
+    std::string variable_place = get_variable_place(variable, function, smart_contract);
+    std::string rival_variable_place = get_variable_place(rival_variable, function, smart_contract);
+
+    // a single token holds both variables, there is no pair of tokens to enumerate
+    if (variable_place == rival_variable_place && is_singleton_place(variable_place)) {
+      return "exists (t in " + variable_place + " | (t->1)." + variable + " " + comparison + " (t->1)." + rival_variable + ")";
     }
-    selection_output_places.unique();
-    return selection_output_places;  
+    return "exists (t in " + variable_place + ", t2 in " + rival_variable_place + " | (t->1)." + variable + " " +
+           comparison + " (t2->1)." + rival_variable + ")";
   }
 
-  // get all variables that were affected address(this).balance value
-  // inside 'function'
-  // we look in assignment and variable declaration statements
-  std::list<std::string> LTLTranslator::get_balance_variables(std::string function, std::string smart_contract=""){
-    std::list<std::string> balance_variables = {"address(this).balance"};
-    for (auto &assignment : assignments){
-        // for reentrancy variable, smart contract is not provided so we only check for function
-      if (assignment.parent == function && (assignment.smart_contract == smart_contract || smart_contract.empty())) {
-        if (!assignment.RHV.empty()){
-          for (auto &RHVariable : assignment.RHV) {
-            if (RHVariable == "address(this).balance") {
-              balance_variables.push_back(assignment.variable);
-            }
-          }
-        }
-      }
+  std::size_t LTLTranslator::QueryKeyHash::operator()(const QueryKey& key) const {
+    std::size_t seed = key.size();
+    for (std::uint32_t id : key) {
+      seed ^= id + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
+    return seed;
+  }
 
-    for (auto &variable_declaration : variable_declarations){
-        // for reentrancy variable, smart contract is not provided so we only check for function
-       if (variable_declaration.parent == function && (variable_declaration.smart_contract == smart_contract || smart_contract.empty())) {
-          if (!variable_declaration.RHV.empty()){
-            for (auto &RHVariable : variable_declaration.RHV) {
-              if (RHVariable == "address(this).balance") {
-                balance_variables.push_back(variable_declaration.variable);
-              }
-            }
-          }
-       }
-    }
-    return balance_variables; 
+  std::uint32_t LTLTranslator::intern(const std::string& _value) {
+    auto interned = interned_strings.emplace(_value, static_cast<std::uint32_t>(interned_strings.size()));
+    return interned.first->second;
   }
 
-  std::list<std::string> LTLTranslator::get_for_loops_output_places(std::string variable,std::string function, std::string smart_contract){
-    std::list<std::string> for_loop_output_places;
-    for (const auto& for_loop: for_loops) {
-      if(for_loop.smart_contract == smart_contract && for_loop.parent == function){
-        if (for_loop.variable == variable && !for_loop.output_place.empty()){
-            for_loop_output_places.push_back(for_loop.output_place);
-          }
-        else if(!for_loop.RHV.empty()){
-          for (auto &RHVariable : for_loop.RHV){
-            if(RHVariable == variable && !for_loop.output_place.empty()){
-              for_loop_output_places.push_back(for_loop.output_place);
-            }
-          }
-        }
-      } 
+  LTLTranslator::QueryKey LTLTranslator::query_key(queries query, const std::vector<std::string>& args,
+                                                   const std::list<std::string>& list_arg) {
+    // dependencies are recorded even when the result comes from the cache
+    record_dependencies(query, args);
+
+    QueryKey key = {static_cast<std::uint32_t>(query)};
+    for (const auto& arg : args) {
+      key.push_back(intern(arg));
+    }
+    for (const auto& arg : list_arg) {
+      key.push_back(intern(arg));
     }
-    for_loop_output_places.unique();
-    return for_loop_output_places;  
+    return key;
   }
 
-  std::list<std::string> LTLTranslator::get_while_loops_output_places(std::string variable,std::string function, std::string smart_contract){
-    std::list<std::string> while_loop_output_places;
-    for (const auto& while_loop: while_loops) {
-      if(while_loop.smart_contract == smart_contract && while_loop.parent == function){
-        if (while_loop.variable == variable && !while_loop.output_place.empty()){
-            while_loop_output_places.push_back(while_loop.output_place);
-          }
-        else if(!while_loop.RHV.empty()){
-          for (auto &RHVariable : while_loop.RHV){
-            if(RHVariable == variable  && !while_loop.output_place.empty()){
-              while_loop_output_places.push_back(while_loop.output_place);
-            }
-          }
-        }
-      } 
+  void LTLTranslator::record_dependencies(queries query, const std::vector<std::string>& args) {
+    auto function_dependency = [this](const std::string& function, const std::string& smart_contract) {
+      // balance variables of a function may be looked for in every contract
+      dependencies.insert(smart_contract.empty() ? "*" : "function:" + smart_contract + "::" + function);
+    };
+
+    switch (query) {
+      // queries with (variable, function, smart contract) arguments
+      case SelectionOutputPlaces:
+      case ForLoopsOutputPlaces:
+      case WhileLoopsOutputPlaces:
+      case RequireOutputPlaces:
+        function_dependency(args[1], args[2]);
+        break;
+      // declarations of the variable are written in any contract
+      case WriteOutputPlaces:
+        function_dependency(args[1], args[2]);
+        dependencies.insert("variable:" + args[0]);
+        break;
+      case ReadOutputPlaces:
+        dependencies.insert("variable:" + args[0]);
+        break;
+      // call sites are pruned by the call graph
+      case FunctionCallOutputPlaces:
+      case FunctionCallInputPlaces:
+        function_dependency(args[0], args[1]);
+        dependencies.insert("calls");
+        break;
+      // queries with (function, smart contract) arguments
+      default:
+        function_dependency(args[0], args[1]);
+        break;
     }
-    while_loop_output_places.unique();
-    return while_loop_output_places;  
   }
 
-  std::list<std::string> LTLTranslator::get_require_output_places(std::string variable,std::string function, std::string smart_contract){
-    std::list<std::string> require_output_places;
-    for (const auto& require: requirements) {
-      if(require.smart_contract == smart_contract && require.parent == function && !require.output_place.empty()){
-        if (require.variable == variable){
-            require_output_places.push_back(require.output_place);
-        }
-        else if(!require.RHV.empty()){
-          for (auto &RHVariable : require.RHV){
-            if(RHVariable == variable){
-              require_output_places.push_back(require.output_place);
-            }
-          }
-        }
-      } 
-    }
-    return require_output_places;  
+  void LTLTranslator::seed(const QueryKey& key, std::list<std::string> places) {
+    query_cache.emplace(key, std::move(places));
   }
 
-  std::list<std::string> LTLTranslator::get_function_call_output_places(std::string function_name, std::string smart_contract){
-    std::list<std::string> function_call_output_places;
-    for (const auto& function_call: function_calls) {
-      if (function_call.function_name == function_name && function_call.smart_contract == smart_contract && !function_call.output_place.empty()){
-          function_call_output_places.push_back(function_call.output_place);
-      }
+  const std::set<std::string>& LTLTranslator::get_dependencies() const {
+    return dependencies;
+  }
+
+  const std::list<std::string>& LTLTranslator::memoize(
+      const QueryKey& key, const std::function<std::list<std::string>()>& compute) {
+    auto cached = query_cache.find(key);
+    if (cached != query_cache.end()) {
+      return cached->second;
     }
+    // compute before inserting, nested queries may grow the cache meanwhile
+    std::list<std::string> places = compute();
+    return query_cache.emplace(key, std::move(places)).first->second;
+  }
 
-    function_call_output_places.unique();
-    return function_call_output_places;
+  std::string LTLTranslator::get_local_variable_placetype(
+      const std::string& _name, const std::string& _function, const std::string& _smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    std::string place = get_variable_place(_name, _function, _smart_contract);
+    return place == "S" ? "" : place;
   }
 
-  std::list<std::string> LTLTranslator::get_function_call_input_places(std::string function_name,std::string smart_contract){
-    std::list<std::string> function_call_input_places;
-    for (const auto& function_call: function_calls) {
-      if (function_call.function_name == function_name && function_call.smart_contract == smart_contract && !function_call.input_place.empty()){
-          function_call_input_places.push_back(function_call.input_place);
-      }
-    }
-    function_call_input_places.unique(); 
-    return function_call_input_places;
+  std::vector<std::pair<std::string, const std::list<Statement>*>> LTLTranslator::statement_lists() const {
+    return {
+      {"assignment", &statement_store->assignments}, {"selection", &statement_store->selections},
+      {"sending", &statement_store->sendings}, {"require", &statement_store->requirements},
+      {"function_call", &statement_store->function_calls},
+      {"variable_declaration", &statement_store->variable_declarations},
+      {"return", &statement_store->returnings}, {"for_loop", &statement_store->for_loops},
+      {"while_loop", &statement_store->while_loops}};
   }
 
-  std::list<std::string> LTLTranslator::get_timestamp_places(std::string function_name, std::string smart_contract){
-    std::list<std::string> timestamp_places;
-    for (const auto& assignment: assignments) {
-      if (assignment.timestamp && assignment.function_name == function_name && assignment.smart_contract == smart_contract && !assignment.output_place.empty()){
-        timestamp_places.push_back(assignment.output_place);
+  std::vector<LTLTranslator::PlaceQuery> LTLTranslator::place_queries(queries query, const std::vector<std::string>& args) const {
+    PlaceQuery place_query;
+    switch (query) {
+      // output places of tests on a variable inside a function
+      case SelectionOutputPlaces:
+      case ForLoopsOutputPlaces:
+      case WhileLoopsOutputPlaces:
+      case RequireOutputPlaces:
+        place_query.types = {query == SelectionOutputPlaces ? "selection"
+                             : query == ForLoopsOutputPlaces ? "for_loop"
+                             : query == WhileLoopsOutputPlaces ? "while_loop" : "require"};
+        place_query.variable = args[0];
+        place_query.variable_match = TestedVariable;
+        place_query.function = args[1];
+        place_query.smart_contract = args[2];
+        place_query.unique = query != RequireOutputPlaces;
+        return {place_query};
+
+      case SendingOutputPlaces:
+        place_query.types = {"sending"};
+        place_query.function = args[0];
+        place_query.smart_contract = args[1];
+        return {place_query};
+
+      // calls to a function anywhere in the smart contract, from the
+      // functions the net runs
+      case FunctionCallOutputPlaces:
+      case FunctionCallInputPlaces:
+        place_query.types = {"function_call"};
+        place_query.function = args[0];
+        place_query.function_match = FunctionNameMatch;
+        place_query.smart_contract = args[1];
+        place_query.place = query == FunctionCallInputPlaces ? InputPlace : OutputPlace;
+        place_query.reachable_only = true;
+        return {place_query};
+
+      case FunctionCallParamPlaces:
+        place_query.types = {"function_call"};
+        place_query.function = args[0];
+        place_query.smart_contract = args[1];
+        place_query.place = ParamPlace;
+        place_query.skip_empty_places = false;
+        return {place_query};
+
+      case TimestampPlaces:
+        place_query.function = args[0];
+        place_query.function_match = EnclosingFunction;
+        place_query.smart_contract = args[1];
+        place_query.timestamp = true;
+        return {place_query};
+
+      // assignments inside the function, then initialized declarations anywhere
+      case WriteOutputPlaces: {
+        place_query.types = {"assignment"};
+        place_query.variable = args[0];
+        place_query.variable_match = WrittenVariable;
+        place_query.function = args[1];
+        place_query.function_match = FunctionNameMatch;
+        place_query.smart_contract = args[2];
+        place_query.unique = false;
+        PlaceQuery declaration_query = place_query;
+        declaration_query.types = {"variable_declaration"};
+        declaration_query.variable_match = InitializedVariable;
+        declaration_query.function_match = AnyFunction;
+        declaration_query.any_contract = true;
+        return {place_query, declaration_query};
       }
-    }
 
-    for (const auto& selection: selections) {
-      if (selection.timestamp && selection.function_name == function_name && selection.smart_contract == smart_contract && !selection.output_place.empty()){
-        timestamp_places.push_back(selection.output_place);
+      // assignments of the smart contract, then the other statements anywhere
+      case ReadOutputPlaces: {
+        place_query.types = {"assignment"};
+        place_query.variable = args[0];
+        place_query.variable_match = ReadVariable;
+        place_query.function_match = AnyFunction;
+        place_query.smart_contract = args[2];
+        place_query.unique = false;
+        std::vector<PlaceQuery> read_queries = {place_query};
+        place_query.any_contract = true;
+        for (const char* type : {"selection", "variable_declaration", "require", "return",
+                                 "sending", "for_loop", "while_loop"}) {
+          place_query.types = {type};
+          read_queries.push_back(place_query);
+        }
+        return read_queries;
       }
-    }
 
-    for (const auto& sending: sendings) {
-      if (sending.timestamp && sending.function_name == function_name && sending.smart_contract == smart_contract && !sending.output_place.empty()){
-        timestamp_places.push_back(sending.output_place);
-      }
+      default:
+        throw std::logic_error("query is not answered by a pass over the statements");
     }
+  }
 
-    for (const auto& requirement: requirements) {
-      if (requirement.timestamp && requirement.function_name == function_name && requirement.smart_contract == smart_contract && !requirement.output_place.empty()){
-        timestamp_places.push_back(requirement.output_place);
-      }
-    }
+  void LTLTranslator::collect_places(const PlaceQuery& query, const std::string& type,
+                                     const Statement& statement, std::list<std::string>& places) const {
+    if (query.timestamp && !statement.timestamp) return;
+    if (!query.any_contract && statement.smart_contract != query.smart_contract) return;
+    // a call site in a function the net never runs is never marked
+    if (query.reachable_only && statement_store->has_entry_points &&
+        statement_store->reachable_functions.count(statement.parent) == 0) {
+      return;
+    }
+
+    switch (query.function_match) {
+      case ParentMatch:
+        if (statement.parent != query.function) return;
+        break;
+      case FunctionNameMatch:
+        if (statement.function_name != query.function) return;
+        break;
+      // the function field of a function call is the called function
+      case EnclosingFunction:
+        if ((type == "function_call" ? statement.parent : statement.function_name) != query.function) return;
+        break;
+      case AnyFunction:
+        break;
+    }
+
+    const std::string& place = query.place == InputPlace ? statement.input_place
+                               : query.place == ParamPlace ? statement.param_place
+                               : statement.output_place;
+    if (query.skip_empty_places && place.empty()) return;
+
+    // number of times the statement answers the query
+    std::size_t matches = 0;
+    switch (query.variable_match) {
+      case AnyVariable:
+        matches = 1;
+        break;
+      case TestedVariable:
+        matches = statement.variable == query.variable
+                      ? 1 : std::count(statement.RHV.begin(), statement.RHV.end(), query.variable);
+        break;
+      case ReadVariable:
+        matches = std::count(statement.RHV.begin(), statement.RHV.end(), query.variable);
+        break;
+      case WrittenVariable:
+        matches = statement.variable == query.variable ? 1 : 0;
+        break;
+      case InitializedVariable:
+        matches = statement.variable == query.variable && !statement.RHV.empty() ? 1 : 0;
+        break;
+    }
+    places.insert(places.end(), matches, place);
+  }
 
-    for (const auto& function_call: function_calls) {
-      if (function_call.timestamp && function_call.parent == function_name && function_call.smart_contract == smart_contract && !function_call.output_place.empty()){
-        timestamp_places.push_back(function_call.output_place);
+  void LTLTranslator::collect_range(const std::vector<PlaceQuery>& place_queries, const StatementRange& range,
+                                    std::vector<std::list<std::string>>& places) const {
+    // each statement is tested against the queries on its type
+    std::vector<std::size_t> candidates;
+    for (std::size_t i = 0; i < place_queries.size(); ++i) {
+      if (place_queries[i].types.empty() || place_queries[i].types.count(range.type) > 0) {
+        candidates.push_back(i);
       }
     }
-
-    for (const auto& variable_declaration: variable_declarations) {
-      if (variable_declaration.timestamp && variable_declaration.function_name == function_name && variable_declaration.smart_contract == smart_contract && !variable_declaration.output_place.empty()){
-        timestamp_places.push_back(variable_declaration.output_place);
+    if (candidates.empty()) return;
+
+    // a query on a function or a variable is only tested against the statements naming it
+    std::unordered_map<std::string, std::vector<std::size_t>> by_parent, by_function_name, by_variable;
+    std::vector<std::size_t> unindexed;
+    for (std::size_t i : candidates) {
+      const PlaceQuery& query = place_queries[i];
+      bool parent_match = query.function_match == ParentMatch ||
+                          (query.function_match == EnclosingFunction && range.type == "function_call");
+      if (query.function_match != AnyFunction) {
+        (parent_match ? by_parent : by_function_name)[query.function].push_back(i);
       }
-    }
-
-    for (const auto& returning: returnings) {
-      if (returning.timestamp && returning.function_name == function_name && returning.smart_contract == smart_contract && !returning.output_place.empty()){
-        timestamp_places.push_back(returning.output_place);
+      else if (query.variable_match != AnyVariable) {
+        by_variable[query.variable].push_back(i);
       }
-    }
-
-    for (const auto& for_loop: for_loops) {
-      if (for_loop.timestamp && for_loop.function_name == function_name && for_loop.smart_contract == smart_contract && !for_loop.output_place.empty()){
-        timestamp_places.push_back(for_loop.output_place);
+      else {
+        unindexed.push_back(i);
       }
     }
 
-    for (const auto& while_loop: while_loops) {
-      if (while_loop.timestamp && while_loop.function_name == function_name && while_loop.smart_contract == smart_contract && !while_loop.output_place.empty()){
-        timestamp_places.push_back(while_loop.output_place);
+    // statement a query was last tested against, a statement may name a variable several times
+    std::vector<const Statement*> tested(place_queries.size(), nullptr);
+    auto test = [&](const std::unordered_map<std::string, std::vector<std::size_t>>& index,
+                    const std::string& key, const Statement& statement) {
+      auto found = index.find(key);
+      if (found == index.end()) return;
+      for (std::size_t i : found->second) {
+        if (tested[i] == &statement) continue;
+        tested[i] = &statement;
+        collect_places(place_queries[i], range.type, statement, places[i]);
+      }
+    };
+
+    for (auto statement = range.begin; statement != range.end; ++statement) {
+      test(by_parent, statement->parent, *statement);
+      test(by_function_name, statement->function_name, *statement);
+      test(by_variable, statement->variable, *statement);
+      for (const auto& RHVariable : statement->RHV) {
+        test(by_variable, RHVariable, *statement);
+      }
+      for (std::size_t i : unindexed) {
+        collect_places(place_queries[i], range.type, *statement, places[i]);
       }
     }
-    timestamp_places.unique();
-    return timestamp_places;     
   }
 
+  std::vector<std::list<std::string>> LTLTranslator::run_queries(const std::vector<PlaceQuery>& place_queries) const {
+    std::vector<std::list<std::string>> places(place_queries.size());
+    const std::vector<StatementRange>& ranges = statement_store->ranges;
 
-  // returns output places for following statements (variable x)
-  // int x = y;
-  // x = y;
-  std::list<std::string> LTLTranslator::get_write_output_places(std::string variable, std::string function, std::string smart_contract){
-    std::list<std::string> write_places;
-    for(auto &assignment : assignments) {
-      if (assignment.variable == variable && assignment.function_name == function && assignment.smart_contract == smart_contract && !assignment.output_place.empty()) {
-        write_places.push_back(assignment.output_place);
+    // single pass over the statements
+    if (scheduler == nullptr || ranges.size() < 2) {
+      for (const auto& range : ranges) {
+        collect_range(place_queries, range, places);
       }
     }
-    for(auto &declaration: variable_declarations) {
-      if (declaration.variable == variable && !declaration.RHV.empty() && !declaration.output_place.empty()) {
-        write_places.push_back(declaration.output_place);
+    // one subtask per range, their places are joined in the order of the ranges
+    else {
+      std::vector<std::vector<std::list<std::string>>> range_places(
+          ranges.size(), std::vector<std::list<std::string>>(place_queries.size()));
+      TaskGroup subtasks(*scheduler);
+      for (std::size_t r = 0; r < ranges.size(); ++r) {
+        subtasks.spawn([this, &place_queries, &ranges, &range_places, r] {
+          collect_range(place_queries, ranges[r], range_places[r]);
+        });
       }
-    }
-    return write_places;     
-  }
-
-  // returns cases for variable x
-  // int x = y;
-  // x = y;
-  std::list<std::string> LTLTranslator::get_read_output_places(std::string variable, std::string function, std::string smart_contract){
-    std::list<std::string> read_places;
-    for (const auto& assignment: assignments) {
-      for (const auto& RHVariable: assignment.RHV){
-        if (RHVariable == variable && assignment.smart_contract == smart_contract && !assignment.output_place.empty()){
-          read_places.push_back(assignment.output_place);
-        } 
+      subtasks.wait();
+      for (auto& range_place : range_places) {
+        for (std::size_t i = 0; i < place_queries.size(); ++i) {
+          places[i].splice(places[i].end(), range_place[i]);
+        }
       }
     }
 
-    for (const auto& selection: selections) {
-      for (const auto& RHVariable: selection.RHV){
-        if (RHVariable == variable && !selection.output_place.empty()){
-          read_places.push_back(selection.output_place);
-        } 
-      }
+    for (std::size_t i = 0; i < place_queries.size(); ++i) {
+      if (place_queries[i].unique) places[i].unique();
     }
+    return places;
+  }
 
-    for (const auto& variable_declaration: variable_declarations) {
-      for (const auto& RHVariable: variable_declaration.RHV){
-        if (RHVariable == variable && !variable_declaration.output_place.empty()){
-          read_places.push_back(variable_declaration.output_place);
-        } 
+  bool LTLTranslator::PlaceQuery::operator<(const PlaceQuery& other) const {
+    return std::tie(types, smart_contract, any_contract, function, function_match, variable, variable_match,
+                    timestamp, place, skip_empty_places, unique, reachable_only) <
+           std::tie(other.types, other.smart_contract, other.any_contract, other.function, other.function_match,
+                    other.variable, other.variable_match, other.timestamp, other.place, other.skip_empty_places,
+                    other.unique, other.reachable_only);
+  }
+
+  std::vector<std::list<std::string>> LTLTranslator::answer_batch(
+      const std::vector<std::pair<queries, std::vector<std::string>>>& batch) {
+    std::vector<std::list<std::string>> answers(batch.size());
+    std::vector<QueryKey> keys;
+    std::vector<std::size_t> missing;
+    std::vector<std::vector<std::size_t>> missing_place_queries;
+    std::vector<PlaceQuery> batch_queries;
+    std::map<PlaceQuery, std::size_t> batch_query_indices;
+
+    // cached answers are reused, the others are gathered in one set of place queries
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      keys.push_back(query_key(batch[i].first, batch[i].second));
+      auto cached = query_cache.find(keys.back());
+      if (cached != query_cache.end()) {
+        answers[i] = cached->second;
+        continue;
+      }
+      missing.push_back(i);
+      missing_place_queries.emplace_back();
+      for (PlaceQuery& query_place : place_queries(batch[i].first, batch[i].second)) {
+        // the same place query asked by several queries is run once, e.g. the
+        // declarations of a variable written by every function of a closure
+        if (query_place.function_match == AnyFunction) query_place.function.clear();
+        if (query_place.any_contract) query_place.smart_contract.clear();
+        auto index = batch_query_indices.emplace(query_place, batch_queries.size());
+        if (index.second) batch_queries.push_back(query_place);
+        missing_place_queries.back().push_back(index.first->second);
       }
     }
+    if (missing.empty()) return answers;
 
-    for (const auto& requirement: requirements) {
-      for (const auto& RHVariable: requirement.RHV){
-        if (RHVariable == variable && !requirement.output_place.empty()){
-          read_places.push_back(requirement.output_place);
-        } 
+    // an answer is the concatenation of the places of its own place queries
+    std::vector<std::list<std::string>> places = run_queries(batch_queries);
+    for (std::size_t j = 0; j < missing.size(); ++j) {
+      std::list<std::string>& answer = answers[missing[j]];
+      for (std::size_t k : missing_place_queries[j]) {
+        answer.insert(answer.end(), places[k].begin(), places[k].end());
       }
+      seed(keys[missing[j]], answer);
     }
+    return answers;
+  }
 
-    for (const auto& returning: returnings) {
-      for (const auto& RHVariable: returning.RHV){
-        if (RHVariable == variable && !returning.output_place.empty()){
-          read_places.push_back(returning.output_place);
-        } 
-      }
+  std::list<std::string> LTLTranslator::answer(queries query, const std::vector<std::string>& args) {
+    return answer_batch({{query, args}}).front();
+  }
+
+  std::list<std::string> LTLTranslator::get_sending_output_places(std::string function, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    std::list<std::string> sending_output_places = answer(SendingOutputPlaces, {function, smart_contract});
+    if(sending_output_places.empty()){
+      std::runtime_error("There are no sending statements in this smart contract");
     }
+    return sending_output_places;
+  }
 
-    for (const auto& sending: sendings) {
-      for (const auto& RHVariable: sending.RHV){
-        if (RHVariable == variable && !sending.output_place.empty()){
-          read_places.push_back(sending.output_place);
-        } 
+  std::list<std::string> LTLTranslator::get_selection_output_places(std::string variable,std::string function, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(SelectionOutputPlaces, {variable, function, smart_contract});
+  }
+
+  // get all variables that were affected address(this).balance value
+  // inside 'function', directly or through other variables
+  // we walk the def-use graph built from assignment and variable declaration statements
+  std::list<std::string> LTLTranslator::get_balance_variables(std::string function, std::string smart_contract=""){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return memoize(query_key(BalanceVariables, {function, smart_contract}), [&]() -> std::list<std::string> {
+      const std::string balance = "address(this).balance";
+      std::list<std::string> balance_variables = {balance};
+
+      auto function_graph = statement_store->def_use_graph.find(function);
+      if (function_graph == statement_store->def_use_graph.end()) {
+        return balance_variables;
       }
-    }
 
-    for (const auto& for_loop: for_loops) {
-      for (const auto& RHVariable: for_loop.RHV){
-        if (RHVariable == variable && !for_loop.output_place.empty()){
-          read_places.push_back(for_loop.output_place);
-        } 
+      // for reentrancy variable, smart contract is not provided so we follow the edges of every contract
+      std::vector<const DefUseEdges*> graphs;
+      for (const auto& contract_graph : function_graph->second) {
+        if (contract_graph.first == smart_contract || smart_contract.empty()) {
+          graphs.push_back(&contract_graph.second);
+        }
       }
-    }
 
-    for (const auto& while_loop: while_loops) {
-      for (const auto& RHVariable: while_loop.RHV){
-        if (RHVariable == variable && !while_loop.output_place.empty()){
-          read_places.push_back(while_loop.output_place);
-        } 
+      // worklist over the def-use edges, each variable is visited once
+      std::unordered_set<std::string> visited = {balance};
+      std::vector<std::string> worklist = {balance};
+      while (!worklist.empty()) {
+        std::string current = worklist.back();
+        worklist.pop_back();
+        for (const DefUseEdges* graph : graphs) {
+          auto uses = graph->find(current);
+          if (uses == graph->end()) {
+            continue;
+          }
+          for (const auto& defined_variable : uses->second) {
+            if (visited.insert(defined_variable).second) {
+              balance_variables.push_back(defined_variable);
+              worklist.push_back(defined_variable);
+            }
+          }
+        }
       }
-    }
+      return balance_variables;
+    });
+  }
+
+  std::list<std::string> LTLTranslator::get_for_loops_output_places(std::string variable,std::string function, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(ForLoopsOutputPlaces, {variable, function, smart_contract});
+  }
+
+  std::list<std::string> LTLTranslator::get_while_loops_output_places(std::string variable,std::string function, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(WhileLoopsOutputPlaces, {variable, function, smart_contract});
+  }
 
+  std::list<std::string> LTLTranslator::get_require_output_places(std::string variable,std::string function, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(RequireOutputPlaces, {variable, function, smart_contract});
+  }
 
-    return read_places;  
+  std::list<std::string> LTLTranslator::get_function_call_output_places(std::string function_name, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(FunctionCallOutputPlaces, {function_name, smart_contract});
+  }
+
+  std::list<std::string> LTLTranslator::get_function_call_input_places(std::string function_name,std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(FunctionCallInputPlaces, {function_name, smart_contract});
+  }
+
+  std::list<std::string> LTLTranslator::get_timestamp_places(std::string function_name, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(TimestampPlaces, {function_name, smart_contract});
+  }
+
+  // returns output places for following statements (variable x)
+  // int x = y;
+  // x = y;
+  std::list<std::string> LTLTranslator::get_write_output_places(std::string variable, std::string function, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(WriteOutputPlaces, {variable, function, smart_contract});
+  }
+
+  // returns cases for variable x
+  // int x = y;
+  // x = y;
+  std::list<std::string> LTLTranslator::get_read_output_places(std::string variable, std::string function, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(ReadOutputPlaces, {variable, function, smart_contract});
   }
 
   std::list<std::string> LTLTranslator::get_function_call_param_places(std::string function, std::string smart_contract){
-    std::list<std::string> function_call_param_places;
-    for (auto &function_call : function_calls) {
-      if(function_call.parent == function && function_call.smart_contract == smart_contract){
-        function_call_param_places.push_back(function_call.param_place);
-      }
-    }
-    function_call_param_places.unique();
-    return function_call_param_places;
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return answer(FunctionCallParamPlaces, {function, smart_contract});
   }
 
   std::list<std::string> LTLTranslator::get_balance_variables_testing_output_places(std::list<std::string> balance_variables, std::string function, std::string smart_contract){
-    std::list<std::string> balance_testing_output_places;
-    for (auto &balance_variable : balance_variables) {
-      std::list<std::string> selection_output_places = get_selection_output_places(balance_variable,function,smart_contract);
-      std::list<std::string> for_loop_output_places = get_for_loops_output_places(balance_variable,function,smart_contract);
-      std::list<std::string> while_loop_output_places = get_while_loops_output_places(balance_variable,function,smart_contract);
-      std::list<std::string> require_output_places = get_require_output_places(balance_variable,function,smart_contract);
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return memoize(query_key(BalanceVariablesTestingOutputPlaces, {function, smart_contract}, balance_variables), [&]() -> std::list<std::string> {
+      // the four tests on every balance variable are answered by one pass
+      std::vector<std::pair<queries, std::vector<std::string>>> batch;
+      for (auto &balance_variable : balance_variables) {
+        for (queries query : {SelectionOutputPlaces, ForLoopsOutputPlaces, WhileLoopsOutputPlaces, RequireOutputPlaces}) {
+          batch.push_back({query, {balance_variable, function, smart_contract}});
+        }
+      }
+      std::vector<std::list<std::string>> test_output_places = answer_batch(batch);
 
       // merge all output places of statements that have tests on balance variables
-      balance_testing_output_places.merge(selection_output_places);
-      balance_testing_output_places.merge(for_loop_output_places);
-      balance_testing_output_places.merge(while_loop_output_places);
-      balance_testing_output_places.merge(require_output_places);
-    }
+      std::list<std::string> balance_testing_output_places;
+      for (auto &output_places : test_output_places) {
+        balance_testing_output_places.merge(output_places);
+      }
 
-    balance_testing_output_places.unique();
-    return balance_testing_output_places;
+      balance_testing_output_places.unique();
+      return balance_testing_output_places;
+    });
   }
 
   // get assignment (assignment and variable declaration statements) output places for all variables that are affected  
   std::list<std::string> LTLTranslator::get_balance_variables_write_statements(std::list<std::string> balance_variables, std::string function, std::string smart_contract){
-    std::list<std::string> assignment_output_places;
-    for (auto &balance_variable : balance_variables){
-      assignment_output_places.merge(get_write_output_places(balance_variable, function, smart_contract));
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+    return memoize(query_key(BalanceVariablesWriteStatements, {function, smart_contract}, balance_variables), [&]() -> std::list<std::string> {
+      std::vector<std::pair<queries, std::vector<std::string>>> batch;
+      for (auto &balance_variable : balance_variables){
+        batch.push_back({WriteOutputPlaces, {balance_variable, function, smart_contract}});
+      }
+
+      std::list<std::string> assignment_output_places;
+      for (auto &write_output_places : answer_batch(batch)) {
+        assignment_output_places.merge(write_output_places);
+      }
+      assignment_output_places.unique();
+      return assignment_output_places;
+    });
+  }
+
+  std::vector<LTLTranslator::FunctionScope> LTLTranslator::get_function_and_callees(const std::string& function,
+                                                                                 const std::string& smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "query");
+    // the callees are resolved against the functions defined by each contract
+    dependencies.insert("calls");
+    dependencies.insert("definitions");
+    FunctionScope caller(smart_contract, function);
+    std::vector<FunctionScope> scopes = {caller};
+    auto component = statement_store->call_components.find(caller);
+    if (component == statement_store->call_components.end()) return scopes;
+
+    auto closure = callee_closures.find(component->second);
+    if (closure == callee_closures.end()) {
+      // breadth-first walk of the calls, the closure of the other components is left alone
+      closure = callee_closures.emplace(component->second, std::vector<FunctionScope>()).first;
+      std::vector<FunctionScope>& callees = closure->second;
+      // the caller is found again when it belongs to a cycle of calls, the
+      // closure then holds the whole component and fits any of its functions
+      std::set<FunctionScope> visited;
+      for (std::size_t next = 0; next <= callees.size(); ++next) {
+        auto next_callees = statement_store->callees.find(next == 0 ? caller : callees[next - 1]);
+        if (next_callees == statement_store->callees.end()) continue;
+        for (const auto& callee : next_callees->second) {
+          if (visited.insert(callee).second) callees.push_back(callee);
+        }
+      }
     }
-    assignment_output_places.unique();
-    return assignment_output_places;
+    for (const auto& callee : closure->second) {
+      if (callee != caller) scopes.push_back(callee);
+    }
+    return scopes;
   }
 
   std::map<std::string, std::string> LTLTranslator::detectSelfDestruction(std::string function,std::string smart_contract, std::string rival_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     // get all variables that reference address(this).balance
     std::list<std::string> balance_variables = get_balance_variables(function,smart_contract);
     std::list<std::string> balance_testing_output_places = get_balance_variables_testing_output_places(balance_variables, function, smart_contract);
@@ -523,9 +924,34 @@ namespace LTL2PROP {
 
   // ltl property reentrancy: ([ ] not (( not assignment ) until (sending))) or ([ ] not (sending))
   std::map<std::string, std::string> LTLTranslator::detectReentrancy(std::string variable, std::string function, std::string smart_contract) {
-    std::list<std::string> balance_variables = get_balance_variables(function, smart_contract);
-    std::list<std::string> sending_output_places = get_sending_output_places(function, smart_contract);
-    std::list<std::string> assignment_output_places = get_balance_variables_write_statements(balance_variables, function, smart_contract);
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
+    // a sending or a balance update may sit in a callee of the function
+    std::vector<FunctionScope> scopes = get_function_and_callees(function, smart_contract);
+
+    // the queries of every function are answered by a single pass
+    std::vector<std::pair<queries, std::vector<std::string>>> batch;
+    for (const auto& scope : scopes) {
+      batch.push_back({SendingOutputPlaces, {scope.second, scope.first}});
+      for (const auto& balance_variable : get_balance_variables(scope.second, scope.first)) {
+        batch.push_back({WriteOutputPlaces, {balance_variable, scope.second, scope.first}});
+      }
+    }
+    answer_batch(batch);
+
+    std::list<std::string> sending_output_places, assignment_output_places;
+    for (const auto& scope : scopes) {
+      std::list<std::string> balance_variables = get_balance_variables(scope.second, scope.first);
+      sending_output_places.splice(sending_output_places.end(), get_sending_output_places(scope.second, scope.first));
+      assignment_output_places.splice(assignment_output_places.end(),
+                                      get_balance_variables_write_statements(balance_variables, scope.second, scope.first));
+    }
+    // a place is found once per function reaching it, e.g. an initialized
+    // declaration of a balance alias of both the caller and a callee
+    sending_output_places.sort();
+    sending_output_places.unique();
+    assignment_output_places.sort();
+    assignment_output_places.unique();
     result["property"] = "ltl property reentrancy: ([] not (not (";
 
 
@@ -590,7 +1016,19 @@ namespace LTL2PROP {
 }
 
 std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std::string function_name, std::string smart_contract) {
-  std::list<std::string> places = get_timestamp_places(function_name, smart_contract);
+  LTL2PROP_TRACE_SCOPE(__func__, "template");
+  LTL2PROP_MEMORY_PHASE(OutputStrings);
+  // timestamps read by the function or by its callees, with a single pass
+  std::vector<std::pair<queries, std::vector<std::string>>> batch;
+  for (const auto& scope : get_function_and_callees(function_name, smart_contract)) {
+    batch.push_back({TimestampPlaces, {scope.second, scope.first}});
+  }
+  std::list<std::string> places;
+  for (auto& scope_places : answer_batch(batch)) {
+    places.splice(places.end(), scope_places);
+  }
+  places.sort();
+  places.unique();
   if (!places.empty()){
     result["property"] = "ltl property tsindependant: [] not (";
     for (auto const& place: places)
@@ -612,6 +1050,8 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
   }
 
   std::map<std::string, std::string> LTLTranslator::detectUninitializedStorageVariable(std::string variable,std::string function, std::string smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     std::list<std::string> write_output_places = get_write_output_places(variable, function, smart_contract);
     std::list<std::string> read_output_places = get_read_output_places(variable, function, smart_contract);
 
@@ -662,27 +1102,24 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
     return result;
   }
 
-  std::map<std::string, std::string> LTLTranslator::detectIntegerUnderOverFlow(std::string variable, std::string min_threshold, std::string max_threshold) {
+  std::map<std::string, std::string> LTLTranslator::detectIntegerUnderOverFlow(std::string variable, std::string min_threshold, std::string max_threshold,
+                                                                                std::string function, std::string smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
+    dependencies.insert("variables");
     result["property"] = "ltl property outOfRange: [] ( not OUFlow ) ;";
-    if (is_global_variable(variable)) {
-      result["propositions"] = "proposition OUFlow: exists (t in S | (t->1)." + variable + " < " + min_threshold +") or exists (t in S | (t->1)." + variable + " > " + max_threshold + ");";
-    }
-    else if (!local_variables[variable].empty())
-    {
-      std::string variable_place = local_variables[variable];
+    std::string variable_place = get_variable_place(variable, function, smart_contract);
 
-      result["propositions"] = "proposition OUFlow: exists (t in "+ variable_place + " | (t->1)." + variable + " < " + min_threshold +") or exists (t in "+ variable_place \
-      +" | (t->1)." + variable + " > " + max_threshold + ");";
-    }
-    else{
-      throw std::runtime_error("Variable " + variable + " doesn't exist in smart contract.");
-    }
-    
+    // both bounds are tested in a single pass over the tokens of the place
+    result["propositions"] = "proposition OUFlow: exists (t in " + variable_place + " | (t->1)." + variable + " < " + min_threshold +
+                             " or (t->1)." + variable + " > " + max_threshold + ");";
     return result;
 
   }
   // look for empty function calls INSIDE function variable
   std::map<std::string, std::string> LTLTranslator::detectSkipEmptyStringLiteral(std::string function, std::string smart_contract){
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     
     std::list<std::string> function_call_inside_function_param_places = get_function_call_param_places(function, smart_contract);
     if (function_call_inside_function_param_places.empty()) {
@@ -705,117 +1142,62 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
   }
 
   /** Check that 'variable's value is always less than either a 'max_threshold' or a 'rival_variable'*/
-  std::map<std::string, std::string> LTLTranslator::checkVariableAlwaysLessThan(std::string variable, std::string rival_variable="", std::string max_threshold =""){
+  std::map<std::string, std::string> LTLTranslator::checkVariableAlwaysLessThan(std::string variable, std::string rival_variable, std::string max_threshold,
+                                                                                std::string function, std::string smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
+    dependencies.insert("variables");
 
     result["property"] = "ltl property smaller: [] not more;";
 
     // compare against a constant
     if(rival_variable.empty()){
-      if (is_global_variable(variable)) {
-        result["propositions"] = "proposition more: exists (t in S | (t->1)." + variable + " > " + max_threshold +");";
-      }
-      else {
-        std::string variable_place = local_variables[variable];
-        result["propositions"] = "proposition more: exists (t in "+ variable_place + " | (t->1)." + variable + " > " + max_threshold +");";
-      }
+      result["propositions"] = "proposition more: exists (t in " + get_variable_place(variable, function, smart_contract) + " | (t->1)." + variable + " > " + max_threshold +");";
     }
     // compare against a rival variable
     else {
-      // both variables are global
-      if (is_global_variable(variable) && is_global_variable(rival_variable)) {
-        result["propositions"] = "proposition more: exists (t in S | (t->1)." + variable + " > (t->1)." + rival_variable +");";
-      }
-      // selected variable is global and rival variable is local
-      else if(is_global_variable(variable)) {
-        std::string rival_variable_place = local_variables[rival_variable];
-        result["propositions"] = "proposition more: exists (t in S, t2 in "+ rival_variable_place + " | (t->1)." + variable + " > (t2->1)." + rival_variable +");";
-      }
-      // selected variable is local and rival variable is local
-      else if(is_global_variable(rival_variable)) {
-        std::string variable_place = local_variables[variable];
-        result["propositions"] = "proposition more: exists (t in "+ variable_place + ", t2 in S | (t->1)." + variable + " > (t2->1)." + rival_variable +");";
-      }
-      // both variables are local
-      else {
-        std::string variable_place = local_variables[variable];
-        std::string rival_variable_place = local_variables[rival_variable];
-        result["propositions"] = "proposition more: exists (t in "+ variable_place + ", t2 in "+ rival_variable_place +" | (t->1)." + variable + " > (t2->1)." + rival_variable +");";
-      }   
-    }  
+      result["propositions"] = "proposition more: " + get_variable_comparison(variable, ">", rival_variable, function, smart_contract) + ";";
+    }
     return result;
   }
 
 
-  std::map<std::string, std::string> LTLTranslator::checkVariableAlwaysMoreThan(std::string variable, std::string rival_variable = "", std::string min_threshold = ""){
+  std::map<std::string, std::string> LTLTranslator::checkVariableAlwaysMoreThan(std::string variable, std::string rival_variable, std::string min_threshold,
+                                                                                std::string function, std::string smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
+    dependencies.insert("variables");
     result["property"] = "ltl property bigger: [] not less;";
 
     if(rival_variable.empty()){
-      if (is_global_variable(variable)) {
-        result["propositions"] = "proposition less: exists (t in S | (t->1)." + variable + " < " + min_threshold +");";
-      }
-      else {
-        std::string variable_place = local_variables[variable];
-        result["propositions"] = "proposition less: exists (t in "+ variable_place + " | (t->1)." + variable + " < " + min_threshold +");";
-      }
+      result["propositions"] = "proposition less: exists (t in " + get_variable_place(variable, function, smart_contract) + " | (t->1)." + variable + " < " + min_threshold +");";
     }
     else {
-      if (is_global_variable(variable) && is_global_variable(rival_variable)) {
-        result["propositions"] = "proposition less: exists (t in S | (t->1)." + variable + " < (t->1)." + rival_variable +");";
-      }
-      else if(is_global_variable(variable)) {
-        std::string rival_variable_place = local_variables[rival_variable];
-        result["propositions"] = "proposition less: exists (t in S, t2 in "+ rival_variable_place + " | (t->1)." + variable + " < (t2->1)." + rival_variable +");";
-      }
-      else if(is_global_variable(rival_variable)) {
-        std::string variable_place = local_variables[variable];
-        result["propositions"] = "proposition less: exists (t in "+ variable_place + ", t2 in S | (t->1)." + variable + " < (t2->1)." + rival_variable +");";
-      }
-      else {
-        std::string variable_place = local_variables[variable];
-        std::string rival_variable_place = local_variables[rival_variable];
-        result["propositions"] = "proposition less: exists (t in "+ variable_place + ", t2 in "+ rival_variable_place +" | (t->1)." + variable + " < (t2->1)." + rival_variable +");";
-
-      }   
-    }  
+      result["propositions"] = "proposition less: " + get_variable_comparison(variable, "<", rival_variable, function, smart_contract) + ";";
+    }
     return result;
   }
 
-  std::map<std::string, std::string> LTLTranslator::checkVariableAlwaysEqualTo(std::string variable, std::string rival_variable="", std::string constant="") {
+  std::map<std::string, std::string> LTLTranslator::checkVariableAlwaysEqualTo(std::string variable, std::string rival_variable, std::string constant,
+                                                                               std::string function, std::string smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
+    dependencies.insert("variables");
     result["property"] = "ltl property equals: [] not different;";
-    
+
     if(rival_variable.empty()){
-      if (is_global_variable(variable)) {
-        result["propositions"] = "proposition different: exists (t in S | (t->1)." + variable + " != " + constant +");";
-      }
-      else
-      {
-        std::string variable_place = local_variables[variable];
-        result["propositions"] = "proposition different: exists (t in "+ variable_place + " | (t->1)." + variable + " != " + constant +");";
-      }
+      result["propositions"] = "proposition different: exists (t in " + get_variable_place(variable, function, smart_contract) + " | (t->1)." + variable + " != " + constant +");";
     }
     else {
-      if (is_global_variable(variable) && is_global_variable(rival_variable)) {
-        result["propositions"] = "proposition different: exists (t in S | (t->1)." + variable + " != (t->1)." + rival_variable +");";
-      }
-      else if(is_global_variable(variable)) {
-        std::string rival_variable_place = local_variables[rival_variable];
-        result["propositions"] = "proposition different: exists (t in S, t2 in "+ rival_variable_place + " | (t->1)." + variable + " != (t2->1)." + rival_variable +");";
-      }
-      else if(is_global_variable(rival_variable)) {
-        std::string variable_place = local_variables[variable];
-        result["propositions"] = "proposition different: exists (t in "+ variable_place + ", t2 in S | (t->1)." + variable + " != (t2->1)." + rival_variable +");";
-      }
-      else {
-        std::string variable_place = local_variables[variable];
-        std::string rival_variable_place = local_variables[rival_variable];
-        result["propositions"] = "proposition different: exists (t in "+ variable_place + ", t2 in "+ rival_variable_place +" | (t->1)." + variable + " != (t2->1)." + rival_variable +");";
-      }   
+      result["propositions"] = "proposition different: " + get_variable_comparison(variable, "!=", rival_variable, function, smart_contract) + ";";
     }
-    return result;  
+    return result;
   }
 
 
   std::map<std::string, std::string> LTLTranslator::checkFunctionIsEventuallyCalled(std::string function_name, std::string smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     std::list<std::string> function_call_input_places = get_function_call_input_places(function_name, smart_contract);
     if(function_call_input_places.empty()){
       result["property"] = "ltl property called: false;";
@@ -838,6 +1220,8 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
 
 
   std::map<std::string, std::string> LTLTranslator::checkFunctionIsNeverCalled(std::string function_name,std::string smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     std::list<std::string> function_call_input_places = get_function_call_input_places(function_name, smart_contract);
     if(function_call_input_places.empty()){
       result["property"] = "ltl property uncalled: true;";
@@ -859,6 +1243,8 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
 
 
   std::map<std::string, std::string> LTLTranslator::checkFunctionIsExecuted(std::string function_name,std::string smart_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     std::list<std::string> function_call_input_places = get_function_call_input_places(function_name, smart_contract);
     std::list<std::string> function_call_output_places = get_function_call_output_places(function_name, smart_contract);
     result["property"] = "ltl property ifcalledthenexecuted: [] ( ( ";
@@ -901,9 +1287,11 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
 
 
   std::map<std::string, std::string> LTLTranslator::checkIsSequentialCall(std::string function_name, std::string smart_contract, std::string rival_function, std::string rival_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     std::list<std::string> function_call_input_places = get_function_call_input_places(function_name, smart_contract);
     std::list<std::string> rival_function_call_input_places = get_function_call_input_places(rival_function, rival_contract); 
-    result["property"] = "property sequentialcall: [] ( ( ";
+    result["property"] = "ltl property sequentialcall: [] ( ( ";
     if (function_call_input_places.empty()) {
       result["propositions"].append("proposition funcallA : false;\n");
       result["property"].append("funcallA ) => <> ( " );    
@@ -941,9 +1329,11 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
 
 
   std::map<std::string, std::string> LTLTranslator::checkIsSequentialExecution(std::string function_name, std::string smart_contract, std::string rival_function, std::string rival_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     std::list<std::string> function_call_output_places = get_function_call_output_places(function_name, smart_contract);
     std::list<std::string> rival_function_call_output_places = get_function_call_output_places(rival_function, rival_contract);
-    result["property"] = "property sequentialexecution: [] ( ( ";
+    result["property"] = "ltl property sequentialexecution: [] ( ( ";
     if (function_call_output_places.empty()) {
       result["propositions"].append("proposition funexecA : false;\n");
       result["property"].append("funexecA ) => <> ( " );
@@ -980,10 +1370,12 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
   }  
 
   std::map<std::string, std::string> LTLTranslator::checkCallFollowedByExec(std::string function_name, std::string smart_contract, std::string rival_function, std::string rival_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     std::list<std::string> function_call_input_places = get_function_call_input_places(function_name, smart_contract);
     std::list<std::string> rival_function_call_output_places = get_function_call_output_places(rival_function, rival_contract);
     
-    result["property"] = "property callfollowedbyexec: [] ( ( "; 
+    result["property"] = "ltl property callfollowedbyexec: [] ( ( "; 
     if (function_call_input_places.empty()) {
       result["propositions"].append("proposition funcallA : false;\n");
       result["property"].append("funcallA ) => <> ( " );
@@ -1020,10 +1412,12 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
   }  
 
   std::map<std::string, std::string> LTLTranslator::checkExecFollowedByCall(std::string function_name, std::string smart_contract, std::string rival_function, std::string rival_contract) {
+    LTL2PROP_TRACE_SCOPE(__func__, "template");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
     std::list<std::string> function_call_output_places = get_function_call_output_places(function_name, smart_contract);
     std::list<std::string> rival_function_call_input_places = get_function_call_input_places(rival_function, rival_contract);
 
-    result["property"] = "property execfollowedbycall: [] ( ( "; 
+    result["property"] = "ltl property execfollowedbycall: [] ( ( "; 
     if (function_call_output_places.empty()) {
       result["propositions"].append("proposition funexecA : false;\n");
       result["property"].append("funexecA ) => <> ( " );
@@ -1059,7 +1453,83 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
     return result;
   } 
 
+  std::vector<nlohmann::json> LTLTranslator::sweep() {
+    LTL2PROP_TRACE_SCOPE(__func__, "sweep");
+    LTL2PROP_MEMORY_PHASE(QueryResults);
+
+    // functions of the net and the global variables each of them reads
+    std::map<FunctionScope, std::set<std::string>> functions;
+    for (const auto& statement_list : statement_lists()) {
+      for (const auto& statement : *statement_list.second) {
+        std::set<std::string>& read_global_variables =
+            functions[FunctionScope(statement.smart_contract, statement.parent)];
+        for (const auto& RHVariable : statement.RHV) {
+          if (is_global_variable(RHVariable)) read_global_variables.insert(RHVariable);
+        }
+      }
+    }
+
+    // every query the swept templates ask is answered by a single batch
+    std::vector<std::pair<queries, std::vector<std::string>>> batch;
+    for (const auto& scope : functions) {
+      const std::string& smart_contract = scope.first.first;
+      const std::string& function = scope.first.second;
+      if (function.empty()) continue;
+
+      batch.push_back({SendingOutputPlaces, {function, smart_contract}});
+      batch.push_back({TimestampPlaces, {function, smart_contract}});
+      batch.push_back({FunctionCallParamPlaces, {function, smart_contract}});
+      for (const auto& balance_variable : get_balance_variables(function, smart_contract)) {
+        for (queries query : {SelectionOutputPlaces, ForLoopsOutputPlaces, WhileLoopsOutputPlaces,
+                              RequireOutputPlaces, WriteOutputPlaces}) {
+          batch.push_back({query, {balance_variable, function, smart_contract}});
+        }
+      }
+      for (const auto& global_variable : scope.second) {
+        batch.push_back({WriteOutputPlaces, {global_variable, function, smart_contract}});
+        batch.push_back({ReadOutputPlaces, {global_variable, function, smart_contract}});
+      }
+    }
+    answer_batch(batch);
+
+    std::vector<nlohmann::json> formulas;
+    for (const auto& scope : functions) {
+      const std::string& smart_contract = scope.first.first;
+      const std::string& function = scope.first.second;
+      if (function.empty()) continue;
+
+      std::vector<std::string> vulnerabilities = {"Reentrancy", "Timestamp Dependance",
+                                                  "Skip Empty String Literal", "Self Destruction"};
+      for (const auto& vulnerability : vulnerabilities) {
+        nlohmann::json inputs = {{"selected_function", function}, {"smart_contract", smart_contract}};
+        if (vulnerability == "Reentrancy") inputs["selected_variable"] = "";
+        if (vulnerability == "Self Destruction") inputs["rival_contract"] = "";
+        formulas.push_back({{"type", "general"}, {"params", {{"name", vulnerability}, {"inputs", inputs}}}});
+      }
+
+      for (const auto& global_variable : scope.second) {
+        nlohmann::json inputs = {{"selected_variable", global_variable},
+                                 {"selected_function", function},
+                                 {"smart_contract", smart_contract}};
+        formulas.push_back({{"type", "general"},
+                            {"params", {{"name", "Uninitialized Storage Variable"}, {"inputs", inputs}}}});
+      }
+    }
+    return formulas;
+  }
+
+  std::map<std::string, std::string> LTLTranslator::translate(const nlohmann::json& ltl_json) {
+    formula_json = ltl_json;
+    return translate();
+  }
+
   std::map<std::string, std::string> LTLTranslator::translate() {
+    LTL2PROP_TRACE_SCOPE(__func__, "translate");
+    LTL2PROP_MEMORY_PHASE(OutputStrings);
+    // start from an empty output, the net and its query cache are kept
+    result = { {"property", ""}, {"propositions", ""}};
+    dependencies.clear();
+
     // get the type of formula : general or specific
     std::string formula_type = formula_json.at("type");
     auto formula_params = formula_json.at("params");
@@ -1073,8 +1543,11 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
           std::string min_threshold = inputs.at("min_threshold");
           std::string max_threshold = inputs.at("max_threshold");
           std::string variable = inputs.at("selected_variable");
+          // the scope of local variables is optional, globals don't need one
+          std::string function = inputs.value("selected_function", "");
+          std::string smart_contract = inputs.value("smart_contract", "");
 
-          return detectIntegerUnderOverFlow(variable, min_threshold, max_threshold);
+          return detectIntegerUnderOverFlow(variable, min_threshold, max_threshold, function, smart_contract);
         }
 
         case(SelfDestruction):{
@@ -1118,29 +1591,35 @@ std::map<std::string, std::string> LTLTranslator::detectTimestampDependance(std:
       }
     }
     else if (formula_type == "specific") {
-      switch(LTLTranslator::getVulnerability(template_name)){
+      switch(LTLTranslator::getPropertyTemplate(template_name)){
         case(VariableAlwaysLessThan):{
           std::string variable = inputs.at("selected_variable");
           std::string rival_variable = inputs.at("rival_variable");
           std::string max_threshold = inputs.at("max_threshold");
+          std::string function = inputs.value("selected_function", "");
+          std::string smart_contract = inputs.value("smart_contract", "");
 
-          return checkVariableAlwaysLessThan(variable, rival_variable, max_threshold); 
+          return checkVariableAlwaysLessThan(variable, rival_variable, max_threshold, function, smart_contract); 
         }
 
         case(VariableAlwaysMoreThan):{
           std::string variable = inputs.at("selected_variable");
           std::string rival_variable = inputs.at("rival_variable");
           std::string min_threshold = inputs.at("min_threshold");
+          std::string function = inputs.value("selected_function", "");
+          std::string smart_contract = inputs.value("smart_contract", "");
 
-          return checkVariableAlwaysMoreThan(variable,rival_variable,min_threshold);
+          return checkVariableAlwaysMoreThan(variable,rival_variable,min_threshold, function, smart_contract);
         }
 
         case(VariableAlwaysEqualTo):{
           std::string variable = inputs.at("selected_variable");
           std::string rival_variable = inputs.at("rival_variable");
           std::string min_threshold = inputs["constant"];
+          std::string function = inputs.value("selected_function", "");
+          std::string smart_contract = inputs.value("smart_contract", "");
 
-          return checkVariableAlwaysEqualTo(variable, rival_variable, min_threshold); 
+          return checkVariableAlwaysEqualTo(variable, rival_variable, min_threshold, function, smart_contract); 
         }
         
         case(FunctionIsEventuallyCalled):{
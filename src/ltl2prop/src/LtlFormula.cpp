@@ -0,0 +1,361 @@
+#include "LtlFormula.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace LTL2PROP {
+
+  namespace {
+
+  /**
+   * @brief Recursive descent parser of Helena LTL properties
+   */
+  class LtlParser {
+   public:
+    explicit LtlParser(const std::string& _text) : text(_text) {
+      next();
+    }
+
+    LtlProperty parse_property() {
+      expect("ltl");
+      expect("property");
+      LtlProperty property;
+      property.name = identifier();
+      expect(":");
+      property.formula = parse_implies();
+      if (token == ";") next();
+      if (!token.empty()) fail();
+      return property;
+    }
+
+   private:
+    LtlFormula parse_implies() {
+      LtlFormula formula = parse_or();
+      if (token == "=>") {
+        next();
+        formula = binary(LtlFormula::Implies, std::move(formula), parse_implies());
+      }
+      return formula;
+    }
+
+    LtlFormula parse_or() {
+      LtlFormula formula = parse_and();
+      while (token == "or") {
+        next();
+        formula = binary(LtlFormula::Or, std::move(formula), parse_and());
+      }
+      return formula;
+    }
+
+    LtlFormula parse_and() {
+      LtlFormula formula = parse_until();
+      while (token == "and") {
+        next();
+        formula = binary(LtlFormula::And, std::move(formula), parse_until());
+      }
+      return formula;
+    }
+
+    LtlFormula parse_until() {
+      LtlFormula formula = parse_unary();
+      if (token == "until") {
+        next();
+        formula = binary(LtlFormula::Until, std::move(formula), parse_until());
+      }
+      return formula;
+    }
+
+    LtlFormula parse_unary() {
+      if (token == "not" || token == "[]" || token == "<>") {
+        LtlFormula::Kind kind = token == "not" ? LtlFormula::Not
+                                : token == "[]" ? LtlFormula::Always
+                                                : LtlFormula::Eventually;
+        next();
+        LtlFormula formula = {kind, "", {}};
+        formula.operands.push_back(parse_unary());
+        return formula;
+      }
+      if (token == "(") {
+        next();
+        LtlFormula formula = parse_implies();
+        expect(")");
+        return formula;
+      }
+      if (token == "true" || token == "false") {
+        LtlFormula formula = {token == "true" ? LtlFormula::True : LtlFormula::False, "", {}};
+        next();
+        return formula;
+      }
+      return {LtlFormula::Atom, identifier(), {}};
+    }
+
+    static LtlFormula binary(LtlFormula::Kind kind, LtlFormula left, LtlFormula right) {
+      LtlFormula formula = {kind, "", {}};
+      formula.operands.push_back(std::move(left));
+      formula.operands.push_back(std::move(right));
+      return formula;
+    }
+
+    std::string identifier() {
+      if (token.empty() || !(std::isalnum(static_cast<unsigned char>(token[0])) || token[0] == '_')) {
+        fail();
+      }
+      std::string name = token;
+      next();
+      return name;
+    }
+
+    void expect(const std::string& expected) {
+      if (token != expected) fail();
+      next();
+    }
+
+    void fail() const {
+      throw std::runtime_error("Could not parse LTL property at \"" + token + "\": " + text);
+    }
+
+    // read the next token, empty at the end of the text
+    void next() {
+      while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+        ++position;
+      }
+      token.clear();
+      if (position >= text.size()) return;
+
+      char c = text[position];
+      if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.') {
+        while (position < text.size() &&
+               (std::isalnum(static_cast<unsigned char>(text[position])) ||
+                text[position] == '_' || text[position] == '.')) {
+          token += text[position++];
+        }
+      }
+      else if (text.compare(position, 2, "[]") == 0 || text.compare(position, 2, "<>") == 0 ||
+               text.compare(position, 2, "=>") == 0) {
+        token = text.substr(position, 2);
+        position += 2;
+      }
+      else {
+        token = std::string(1, c);
+        ++position;
+      }
+    }
+
+    const std::string& text;
+    std::size_t position = 0;
+    std::string token;
+  };
+
+  std::string trim(const std::string& text) {
+    std::size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    std::size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+  }
+
+  bool is_name_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+  }
+
+  // places and quantifications read by the expression of a proposition
+  void parse_expression(Proposition& proposition) {
+    const std::string& expression = proposition.expression;
+
+    // quantifications: exists (t in P, t2 in Q | condition)
+    std::string outside;
+    std::size_t position = 0;
+    while (true) {
+      std::size_t exists = expression.find("exists", position);
+      std::size_t open = expression.find('(', exists);
+      std::size_t bar = expression.find('|', open);
+      if (exists == std::string::npos || open == std::string::npos || bar == std::string::npos) {
+        outside += expression.substr(position);
+        break;
+      }
+      std::size_t close = open;
+      for (int depth = 0; close < expression.size(); ++close) {
+        if (expression[close] == '(') ++depth;
+        if (expression[close] == ')' && --depth == 0) break;
+      }
+      outside += expression.substr(position, exists - position);
+
+      Quantification quantification;
+      std::istringstream binders(expression.substr(open + 1, bar - open - 1));
+      std::string binder;
+      while (std::getline(binders, binder, ',')) {
+        std::size_t in = binder.find(" in ");
+        if (in == std::string::npos) continue;
+        quantification.places.push_back(trim(binder.substr(in + 4)));
+      }
+      quantification.condition = expression.substr(bar + 1, close - bar - 1);
+      proposition.quantifications.push_back(quantification);
+      position = std::min(close + 1, expression.size());
+    }
+
+    // cardinality tests outside of quantifications, (t->1)'last'card is not a place
+    for (std::size_t card = outside.find("'card"); card != std::string::npos;
+         card = outside.find("'card", card + 1)) {
+      std::size_t begin = card;
+      while (begin > 0 && is_name_char(outside[begin - 1])) --begin;
+      if (begin == card || (begin > 0 && outside[begin - 1] == '\'')) continue;
+      proposition.places.push_back(outside.substr(begin, card - begin));
+    }
+  }
+
+  bool is_constant(const LtlFormula& formula) {
+    return formula.kind == LtlFormula::True || formula.kind == LtlFormula::False;
+  }
+
+  LtlFormula constant(bool value) {
+    return {value ? LtlFormula::True : LtlFormula::False, "", {}};
+  }
+
+  }  // namespace
+
+  std::string Proposition::kind() const {
+    if (!quantifications.empty()) return "quantified";
+    if (!places.empty()) return "cardinality";
+    return "constant";
+  }
+
+  LtlProperty parse_ltl_property(const std::string& property) {
+    return LtlParser(property).parse_property();
+  }
+
+  std::vector<Proposition> parse_propositions(const std::string& propositions) {
+    std::vector<Proposition> parsed;
+    std::set<std::string> defined;
+    std::istringstream lines(propositions);
+    std::string line;
+    while (std::getline(lines, line)) {
+      line = trim(line);
+      std::size_t keyword_end = line.find(' ');
+      std::size_t colon = line.find(':');
+      if (keyword_end == std::string::npos || colon == std::string::npos || colon < keyword_end) continue;
+      std::string keyword = line.substr(0, keyword_end);
+      if (keyword != "proposition" && keyword != "property") continue;
+
+      Proposition proposition;
+      proposition.name = trim(line.substr(keyword_end, colon - keyword_end));
+      if (!defined.insert(proposition.name).second) continue;
+      proposition.expression = trim(line.substr(colon + 1));
+      if (!proposition.expression.empty() && proposition.expression.back() == ';') {
+        proposition.expression.pop_back();
+      }
+      parse_expression(proposition);
+      parsed.push_back(proposition);
+    }
+    return parsed;
+  }
+
+  std::map<std::string, bool> constant_propositions(const std::vector<Proposition>& propositions) {
+    std::map<std::string, bool> constants;
+    for (const auto& proposition : propositions) {
+      // (false) is false
+      std::string expression = proposition.expression;
+      while (expression.size() > 1 && expression.front() == '(' && expression.back() == ')') {
+        expression = trim(expression.substr(1, expression.size() - 2));
+      }
+      if (expression == "true" || expression == "false") constants[proposition.name] = expression == "true";
+    }
+    return constants;
+  }
+
+  LtlFormula simplify(const LtlFormula& formula, const std::map<std::string, bool>& constants) {
+    if (formula.kind == LtlFormula::Atom) {
+      auto value = constants.find(formula.atom);
+      return value == constants.end() ? formula : constant(value->second);
+    }
+
+    LtlFormula simplified = {formula.kind, formula.atom, {}};
+    for (const auto& operand : formula.operands) simplified.operands.push_back(simplify(operand, constants));
+    if (simplified.operands.empty()) return simplified;
+
+    const LtlFormula& left = simplified.operands.front();
+    const LtlFormula& right = simplified.operands.back();
+    switch (formula.kind) {
+      case LtlFormula::Not:
+        if (is_constant(left)) return constant(left.kind == LtlFormula::False);
+        break;
+      case LtlFormula::Always:
+      case LtlFormula::Eventually:
+        if (is_constant(left)) return left;
+        break;
+      case LtlFormula::Until:
+        if (is_constant(right)) return right;
+        if (left.kind == LtlFormula::False) return right;
+        if (left.kind == LtlFormula::True) {
+          LtlFormula eventually = {LtlFormula::Eventually, "", {}};
+          eventually.operands.push_back(right);
+          return eventually;
+        }
+        break;
+      case LtlFormula::And:
+      case LtlFormula::Or: {
+        // true is absorbing for or and neutral for and, false the opposite
+        LtlFormula::Kind absorbing = formula.kind == LtlFormula::Or ? LtlFormula::True : LtlFormula::False;
+        if (left.kind == absorbing || right.kind == absorbing) return constant(absorbing == LtlFormula::True);
+        if (is_constant(left)) return right;
+        if (is_constant(right)) return left;
+        break;
+      }
+      case LtlFormula::Implies:
+        if (left.kind == LtlFormula::False || right.kind == LtlFormula::True) return constant(true);
+        if (left.kind == LtlFormula::True) return right;
+        if (right.kind == LtlFormula::False) {
+          LtlFormula negation = {LtlFormula::Not, "", {}};
+          negation.operands.push_back(left);
+          return negation;
+        }
+        break;
+      default:
+        break;
+    }
+    return simplified;
+  }
+
+  Verdict static_verdict(const std::string& property, const std::string& propositions) {
+    LtlFormula formula;
+    try {
+      formula = parse_ltl_property(property).formula;
+    }
+    catch (const std::runtime_error&) {
+      return Verdict::Undecided;
+    }
+    formula = simplify(formula, constant_propositions(parse_propositions(propositions)));
+    if (formula.kind == LtlFormula::True) return Verdict::Holds;
+    if (formula.kind == LtlFormula::False) return Verdict::Violated;
+    return Verdict::Undecided;
+  }
+
+  std::string to_string(const LtlFormula& formula) {
+    switch (formula.kind) {
+      case LtlFormula::Atom:
+        return formula.atom;
+      case LtlFormula::True:
+        return "true";
+      case LtlFormula::False:
+        return "false";
+      case LtlFormula::Not:
+        return "not (" + to_string(formula.operands[0]) + ")";
+      case LtlFormula::Always:
+        return "[] (" + to_string(formula.operands[0]) + ")";
+      case LtlFormula::Eventually:
+        return "<> (" + to_string(formula.operands[0]) + ")";
+      case LtlFormula::Until:
+        return "(" + to_string(formula.operands[0]) + ") until (" + to_string(formula.operands[1]) + ")";
+      case LtlFormula::And:
+        return "(" + to_string(formula.operands[0]) + ") and (" + to_string(formula.operands[1]) + ")";
+      case LtlFormula::Or:
+        return "(" + to_string(formula.operands[0]) + ") or (" + to_string(formula.operands[1]) + ")";
+      case LtlFormula::Implies:
+        return "(" + to_string(formula.operands[0]) + ") => (" + to_string(formula.operands[1]) + ")";
+    }
+    return "";
+  }
+
+}  // namespace LTL2PROP
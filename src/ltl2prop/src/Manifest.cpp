@@ -0,0 +1,207 @@
+#include "Manifest.hpp"
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include "LtlFormula.hpp"
+
+namespace LTL2PROP {
+
+  namespace {
+
+  /**
+   * @brief Temporal operators of a formula, once negations are pushed down
+   */
+  struct TemporalOperators {
+    bool always = false;
+    bool eventually = false;
+    bool until = false;
+  };
+
+  void temporal_operators(const LtlFormula& formula, bool negated, TemporalOperators& operators) {
+    if (formula.kind == LtlFormula::Not) negated = !negated;
+    // not [] p is <> not p, and not <> p is [] not p
+    if (formula.kind == LtlFormula::Always) (negated ? operators.eventually : operators.always) = true;
+    if (formula.kind == LtlFormula::Eventually) (negated ? operators.always : operators.eventually) = true;
+    if (formula.kind == LtlFormula::Until) operators.until = true;
+    // p => q is not p or q
+    for (std::size_t i = 0; i < formula.operands.size(); ++i) {
+      temporal_operators(formula.operands[i], formula.kind == LtlFormula::Implies && i == 0 ? !negated : negated,
+                         operators);
+    }
+  }
+
+  void atoms(const LtlFormula& formula, std::set<std::string>& names) {
+    if (formula.kind == LtlFormula::Atom) names.insert(formula.atom);
+    for (const auto& operand : formula.operands) atoms(operand, names);
+  }
+
+  std::string formula_class(const LtlFormula& formula) {
+    if (formula.kind == LtlFormula::True || formula.kind == LtlFormula::False) return "constant";
+    TemporalOperators operators;
+    temporal_operators(formula, false, operators);
+    if (operators.until) return "until";
+    if (operators.eventually) return "liveness";
+    if (operators.always) return "invariant";
+    return "state";
+  }
+
+  // the manifest is written directly, a JSON document of the statements
+  // would cost much more than the translation on large nets
+
+  void write_string(std::string& out, const std::string& value) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (char c : value) {
+      if (c == '"' || c == '\\') {
+        out += '\\';
+        out += c;
+      }
+      else if (static_cast<unsigned char>(c) < 0x20) {
+        out += "\\u00";
+        out += hex[(c >> 4) & 0xf];
+        out += hex[c & 0xf];
+      }
+      else {
+        out += c;
+      }
+    }
+    out += '"';
+  }
+
+  void write_field(std::string& out, const char* key, const std::string& value) {
+    out += ",\"";
+    out += key;
+    out += "\":";
+    write_string(out, value);
+  }
+
+  void write_statement(std::string& out, std::size_t position, const Statement& statement) {
+    out += "{\"index\":" + std::to_string(position);
+    write_field(out, "type", statement.type);
+    write_field(out, "smart_contract", statement.smart_contract);
+    write_field(out, "function", statement.parent);
+    if (statement.type == "function_call") write_field(out, "called_function", statement.function_name);
+    write_field(out, "input_place", statement.input_place);
+    write_field(out, "output_place", statement.output_place);
+    write_field(out, "param_place", statement.param_place);
+    out += '}';
+  }
+
+  }  // namespace
+
+  PlaceIndex::PlaceIndex(const Net& _net) : net(_net) {
+    for (std::size_t position = 0; position < net.statements.size(); ++position) {
+      const Statement& statement = net.statements[position];
+      std::set<std::string> places = {statement.input_place, statement.output_place, statement.param_place};
+      for (const auto& place : places) {
+        if (!place.empty()) place_statements[place].push_back(position);
+      }
+    }
+  }
+
+  const std::vector<std::size_t>& PlaceIndex::statements(const std::string& place) const {
+    static const std::vector<std::size_t> none;
+    auto found = place_statements.find(place);
+    return found == place_statements.end() ? none : found->second;
+  }
+
+  std::size_t PlaceIndex::statement_count() const {
+    return net.statements.size();
+  }
+
+  const Statement& PlaceIndex::statement(std::size_t position) const {
+    return net.statements.at(position);
+  }
+
+  std::string translation_manifest(const std::map<std::string, std::string>& translation,
+                                   const PlaceIndex& index) {
+    auto property_text = translation.find("property");
+    auto propositions_text = translation.find("propositions");
+
+    std::vector<Proposition> propositions =
+        parse_propositions(propositions_text == translation.end() ? "" : propositions_text->second);
+
+    std::string manifest = "{\"property\":";
+    std::set<std::string> used_atoms;
+    bool parsed = false;
+    if (property_text != translation.end()) {
+      try {
+        LtlProperty property = parse_ltl_property(property_text->second);
+        // a property whose constant propositions decide it needs no exploration
+        LtlFormula formula = simplify(property.formula, constant_propositions(propositions));
+        write_string(manifest, property.name);
+        write_field(manifest, "class", formula_class(formula));
+        manifest += ",\"constant\":";
+        manifest += formula.kind == LtlFormula::True    ? "true"
+                    : formula.kind == LtlFormula::False ? "false"
+                                                        : "null";
+        atoms(property.formula, used_atoms);
+        parsed = true;
+      }
+      catch (const std::runtime_error&) {
+        // the propositions of a property that cannot be parsed are all listed as used
+      }
+    }
+    if (!parsed) manifest += "null,\"class\":\"unknown\",\"constant\":null";
+
+    manifest += ",\"propositions\":[";
+    // statements listed by a proposition
+    std::vector<bool> sources(index.statement_count(), false);
+    bool first = true;
+    for (const auto& proposition : propositions) {
+      // places in the order they appear, cardinality tests first
+      std::vector<std::string> places;
+      std::set<std::string> listed;
+      for (const auto& place : proposition.places) {
+        if (listed.insert(place).second) places.push_back(place);
+      }
+      for (const auto& quantification : proposition.quantifications) {
+        for (const auto& place : quantification.places) {
+          if (listed.insert(place).second) places.push_back(place);
+        }
+      }
+
+      std::vector<std::size_t> statements;
+      for (const auto& place : places) {
+        const std::vector<std::size_t>& place_statements = index.statements(place);
+        statements.insert(statements.end(), place_statements.begin(), place_statements.end());
+      }
+      if (places.size() > 1) {
+        std::sort(statements.begin(), statements.end());
+        statements.erase(std::unique(statements.begin(), statements.end()), statements.end());
+      }
+
+      manifest += first ? "{\"name\":" : ",{\"name\":";
+      first = false;
+      write_string(manifest, proposition.name);
+      write_field(manifest, "kind", proposition.kind());
+      manifest += ",\"places\":[";
+      for (std::size_t i = 0; i < places.size(); ++i) {
+        if (i > 0) manifest += ',';
+        write_string(manifest, places[i]);
+      }
+      manifest += "],\"used\":";
+      manifest += !parsed || used_atoms.count(proposition.name) > 0 ? "true" : "false";
+      manifest += ",\"statements\":[";
+      for (std::size_t i = 0; i < statements.size(); ++i) {
+        if (i > 0) manifest += ',';
+        manifest += std::to_string(statements[i]);
+        sources[statements[i]] = true;
+      }
+      manifest += "]}";
+    }
+
+    manifest += "],\"statements\":[";
+    first = true;
+    for (std::size_t position = 0; position < sources.size(); ++position) {
+      if (!sources[position]) continue;
+      if (!first) manifest += ',';
+      first = false;
+      write_statement(manifest, position, index.statement(position));
+    }
+    manifest += "]}";
+    return manifest;
+  }
+
+}  // namespace LTL2PROP
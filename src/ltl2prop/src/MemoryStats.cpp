@@ -0,0 +1,170 @@
+#include "MemoryStats.hpp"
+
+#ifdef LTL2PROP_MEMORY_STATS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace LTL2PROP {
+
+  namespace {
+
+  const int phase_count = static_cast<int>(MemoryPhase::OutputStrings) + 1;
+  const char* const phase_names[phase_count] = {
+    "other", "json dom", "statement store", "query results", "output strings",
+  };
+
+  // size classes [2^k, 2^(k+1)), the first one also holds empty allocations
+  const int size_class_count = 48;
+
+  /**
+   * @brief Header stored in front of each allocated block
+   */
+  struct alignas(alignof(std::max_align_t)) BlockHeader {
+    std::size_t size;
+    int phase;
+  };
+
+  struct PhaseCounters {
+    std::atomic<std::size_t> allocations;
+    std::atomic<std::size_t> bytes;
+    std::atomic<std::size_t> live_bytes;
+    std::atomic<std::size_t> peak_live_bytes;
+  };
+
+  // zero-initialized before any allocation
+  PhaseCounters phase_counters[phase_count];
+  std::atomic<std::size_t> live_bytes;
+  std::atomic<std::size_t> peak_live_bytes;
+  std::atomic<std::size_t> size_classes[size_class_count];
+
+  thread_local MemoryPhase current_phase = MemoryPhase::Other;
+
+  void raise_peak(std::atomic<std::size_t>& peak, std::size_t value) {
+    std::size_t previous = peak.load(std::memory_order_relaxed);
+    while (value > previous &&
+           !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  int size_class(std::size_t size) {
+    int size_class = 0;
+    while (size > 1 && size_class < size_class_count - 1) {
+      size >>= 1;
+      ++size_class;
+    }
+    return size_class;
+  }
+
+  void* allocate(std::size_t size) {
+    void* block = std::malloc(sizeof(BlockHeader) + size);
+    if (block == nullptr) return nullptr;
+
+    int phase = static_cast<int>(current_phase);
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->size = size;
+    header->phase = phase;
+
+    PhaseCounters& counters = phase_counters[phase];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+    raise_peak(counters.peak_live_bytes,
+               counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+    raise_peak(peak_live_bytes, live_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+    size_classes[size_class(size)].fetch_add(1, std::memory_order_relaxed);
+    return header + 1;
+  }
+
+  // allocate, calling the new handler until it gives up
+  void* allocate_or_throw(std::size_t size) {
+    void* pointer;
+    while ((pointer = allocate(size)) == nullptr) {
+      std::new_handler handler = std::get_new_handler();
+      if (handler == nullptr) throw std::bad_alloc();
+      handler();
+    }
+    return pointer;
+  }
+
+  void deallocate(void* pointer) {
+    if (pointer == nullptr) return;
+    BlockHeader* header = static_cast<BlockHeader*>(pointer) - 1;
+    phase_counters[header->phase].live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    std::free(header);
+  }
+
+  /**
+   * @brief Print the statistics when the program exits
+   */
+  struct MemoryReport {
+    ~MemoryReport() {
+      // stdio only, so that the report doesn't allocate
+      std::fprintf(stderr, "memory: peak heap %zu bytes\n", peak_live_bytes.load());
+      std::fprintf(stderr, "memory: %-16s %12s %14s %14s\n", "phase", "allocations", "bytes",
+                   "peak bytes");
+      for (int phase = 0; phase < phase_count; ++phase) {
+        const PhaseCounters& counters = phase_counters[phase];
+        std::fprintf(stderr, "memory: %-16s %12zu %14zu %14zu\n", phase_names[phase],
+                     counters.allocations.load(), counters.bytes.load(),
+                     counters.peak_live_bytes.load());
+      }
+      std::fprintf(stderr, "memory: %-16s %12s\n", "size class", "allocations");
+      for (int size_class = 0; size_class < size_class_count; ++size_class) {
+        if (size_classes[size_class].load() == 0) continue;
+        std::fprintf(stderr, "memory: < 2^%-12d %12zu\n", size_class + 1,
+                     size_classes[size_class].load());
+      }
+    }
+  };
+
+  MemoryReport memory_report;
+
+  }  // namespace
+
+  MemoryPhaseScope::MemoryPhaseScope(MemoryPhase phase) : previous_phase(current_phase) {
+    current_phase = phase;
+  }
+
+  MemoryPhaseScope::~MemoryPhaseScope() {
+    current_phase = previous_phase;
+  }
+
+}  // namespace LTL2PROP
+
+void* operator new(std::size_t size) {
+  return LTL2PROP::allocate_or_throw(size);
+}
+
+void* operator new[](std::size_t size) {
+  return LTL2PROP::allocate_or_throw(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return LTL2PROP::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return LTL2PROP::allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  LTL2PROP::deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  LTL2PROP::deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  LTL2PROP::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  LTL2PROP::deallocate(pointer);
+}
+
+#endif  // LTL2PROP_MEMORY_STATS
@@ -0,0 +1,77 @@
+#include "Net.hpp"
+
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include "json.hpp"
+
+namespace LTL2PROP {
+
+  void Net::append(Net&& other) {
+    global_variables.splice(global_variables.end(), other.global_variables);
+    local_variables.insert(local_variables.end(),
+                           std::make_move_iterator(other.local_variables.begin()),
+                           std::make_move_iterator(other.local_variables.end()));
+    statements.insert(statements.end(),
+                      std::make_move_iterator(other.statements.begin()),
+                      std::make_move_iterator(other.statements.end()));
+    place_capacities.insert(other.place_capacities.begin(), other.place_capacities.end());
+    entry_points.insert(entry_points.end(),
+                        std::make_move_iterator(other.entry_points.begin()),
+                        std::make_move_iterator(other.entry_points.end()));
+  }
+
+  Statement statement_from_json(const nlohmann::json& statement) {
+    Statement s = {
+      .type = statement.at("type"),
+      .smart_contract = statement.at("smart_contract"),
+      .parent = statement.at("parent"),
+      .variable = statement.at("variable"),
+      .function_name = statement.at("function"),
+      .input_place = statement.at("input_place"),
+      .output_place = statement.at("output_place"),
+      .param_place = statement.at("param_place"),
+      .RHV = statement.at("right_hand_variables").get<std::list<std::string>>(),
+      .timestamp = statement.at("timestamp"),
+    };
+    return s;
+  }
+
+  Net net_from_json(const nlohmann::json& lna_json) {
+    Net net;
+    // get global variables
+    for (const auto& global_var : lna_json.at("global_variables")) {
+      net.global_variables.push_back(global_var.at("name"));
+    }
+
+    // get local variables from functions
+    for (const auto& function : lna_json.at("functions")) {
+      // local variables are looked up in the scope of their function
+      if (!function.contains("name") || !function.contains("smart_contract")) {
+        throw std::runtime_error("A function of the lna-info lacks its name or its smart contract, "
+                                 "its local variables can't be scoped.");
+      }
+      for (const auto& local_var : function.at("local_variables")) {
+        net.local_variables.push_back({function.at("smart_contract"), function.at("name"),
+                                       local_var.at("name"), local_var.at("place")});
+      }
+    }
+
+    // get place capacities, when solidity2cpn provides them
+    for (const auto& place : lna_json.value("places", nlohmann::json::array())) {
+      net.place_capacities[place.at("name")] = place.at("capacity");
+    }
+
+    // get entry points, when solidity2cpn provides them
+    for (const auto& entry_point : lna_json.value("entry_points", nlohmann::json::array())) {
+      net.entry_points.push_back(entry_point);
+    }
+
+    // get statements
+    for (const auto& statement : lna_json.at("statements")) {
+      net.statements.push_back(statement_from_json(statement));
+    }
+    return net;
+  }
+
+}  // namespace LTL2PROP
@@ -0,0 +1,154 @@
+#include "NetFile.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include "Trace.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LTL2PROP_HAS_POSIX_FILES 1
+#endif
+
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#define LTL2PROP_HAS_COPY_FILE_RANGE 1
+#endif
+#endif
+
+namespace LTL2PROP {
+
+  namespace {
+
+  // size of the blocks read from the end of a net to find its closing brace
+  const std::streamoff tail_block_size = 4096;
+
+#ifdef LTL2PROP_HAS_POSIX_FILES
+  /**
+   * @brief File descriptor closed when going out of scope
+   */
+  class FileDescriptor {
+   public:
+    explicit FileDescriptor(int _fd) : fd(_fd) {}
+    ~FileDescriptor() {
+      if (fd >= 0) ::close(fd);
+    }
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    int get() const { return fd; }
+
+   private:
+    int fd;
+  };
+#endif
+
+  }  // namespace
+
+  void clone_file(const std::string& source, const std::string& destination) {
+    LTL2PROP_TRACE_SCOPE(__func__, "write", destination);
+#ifdef LTL2PROP_HAS_POSIX_FILES
+    FileDescriptor source_fd(::open(source.c_str(), O_RDONLY));
+    struct stat source_stat;
+    if (source_fd.get() < 0 || ::fstat(source_fd.get(), &source_stat) != 0) {
+      throw std::runtime_error("Could not open net file " + source);
+    }
+    FileDescriptor destination_fd(::open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                                         source_stat.st_mode & 0777));
+    if (destination_fd.get() < 0) {
+      throw std::runtime_error("Could not create net file " + destination);
+    }
+
+#ifdef FICLONE
+    // the copy shares the blocks of the source until one of them is modified
+    if (::ioctl(destination_fd.get(), FICLONE, source_fd.get()) == 0) return;
+#endif
+
+#ifdef LTL2PROP_HAS_COPY_FILE_RANGE
+    // both offsets move forward, so a failed copy is finished by read/write
+    off_t remaining = source_stat.st_size;
+    while (remaining > 0) {
+      ssize_t copied = ::copy_file_range(source_fd.get(), nullptr, destination_fd.get(),
+                                         nullptr, remaining, 0);
+      if (copied <= 0) break;
+      remaining -= copied;
+    }
+    if (remaining == 0) return;
+#endif
+
+    std::vector<char> buffer(1 << 16);
+    ssize_t read_size;
+    while ((read_size = ::read(source_fd.get(), buffer.data(), buffer.size())) > 0) {
+      for (ssize_t written = 0; written < read_size;) {
+        ssize_t write_size = ::write(destination_fd.get(), buffer.data() + written,
+                                     read_size - written);
+        if (write_size < 0) {
+          throw std::runtime_error("Could not write net file " + destination);
+        }
+        written += write_size;
+      }
+    }
+    if (read_size < 0) {
+      throw std::runtime_error("Could not read net file " + source);
+    }
+#else
+    std::ifstream source_stream(source, std::ios::binary);
+    if (!source_stream) {
+      throw std::runtime_error("Could not open net file " + source);
+    }
+    std::ofstream destination_stream(destination, std::ios::binary | std::ios::trunc);
+    if (!destination_stream) {
+      throw std::runtime_error("Could not create net file " + destination);
+    }
+    destination_stream << source_stream.rdbuf();
+#endif
+  }
+
+  void append_propositions(const std::string& filename, const std::string& propositions) {
+    LTL2PROP_TRACE_SCOPE(__func__, "write", filename);
+    std::fstream net_stream(filename, std::ios::in | std::ios::out | std::ios::binary);
+    if (!net_stream) {
+      throw std::runtime_error("Could not open net file " + filename);
+    }
+
+    // look for the last closing brace, reading the file backwards
+    net_stream.seekg(0, std::ios::end);
+    std::streamoff size = net_stream.tellg();
+    std::streamoff brace_position = -1;
+    std::string tail;
+    std::vector<char> block(tail_block_size);
+    for (std::streamoff block_end = size; block_end > 0 && brace_position < 0;) {
+      std::streamoff block_begin = std::max<std::streamoff>(0, block_end - tail_block_size);
+      std::size_t block_length = static_cast<std::size_t>(block_end - block_begin);
+      net_stream.seekg(block_begin);
+      net_stream.read(block.data(), block_length);
+
+      auto brace = std::find(block.rbegin() + (block.size() - block_length), block.rend(), '}');
+      if (brace != block.rend()) {
+        brace_position = block_begin + (block.rend() - brace) - 1;
+      }
+      block_end = block_begin;
+    }
+
+    // what follows the brace is kept, before the propositions
+    if (brace_position >= 0) {
+      tail.resize(static_cast<std::size_t>(size - brace_position - 1));
+      net_stream.seekg(brace_position + 1);
+      net_stream.read(&tail[0], tail.size());
+    }
+
+    net_stream.clear();
+    net_stream.seekp(brace_position >= 0 ? brace_position : size);
+    net_stream << tail << propositions << '\n' << '}' << '\n';
+    if (!net_stream) {
+      throw std::runtime_error("Could not write net file " + filename);
+    }
+  }
+
+}  // namespace LTL2PROP
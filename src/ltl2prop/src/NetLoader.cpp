@@ -0,0 +1,583 @@
+#include "NetLoader.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "json.hpp"
+#include "IncrementalIndex.hpp"
+#include "MemoryStats.hpp"
+#include "Trace.hpp"
+
+#ifndef LTL2PROP_DEFAULT_JSON_BACKEND
+#define LTL2PROP_DEFAULT_JSON_BACKEND "sax"
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LTL2PROP_HAS_MMAP 1
+#endif
+
+namespace LTL2PROP {
+
+  namespace {
+
+  /**
+   * @brief Read-only view on the content of a file, memory-mapped when the
+   * platform allows it
+   */
+  class FileView {
+   public:
+    explicit FileView(const std::string& filename) {
+#ifdef LTL2PROP_HAS_MMAP
+      int fd = ::open(filename.c_str(), O_RDONLY);
+      struct stat file_stat;
+      if (fd >= 0 && ::fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+        void* mapped = ::mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+          ::madvise(mapped, file_stat.st_size, MADV_SEQUENTIAL);
+          mapped_data = static_cast<const char*>(mapped);
+          mapped_size = file_stat.st_size;
+        }
+      }
+      if (fd >= 0) ::close(fd);
+      if (mapped_data != nullptr) return;
+#endif
+      // fall back on reading the whole file
+      std::ifstream file_stream(filename);
+      if (!file_stream) {
+        throw std::runtime_error("Could not open lna-info file " + filename);
+      }
+      content.assign(std::istreambuf_iterator<char>(file_stream),
+                     std::istreambuf_iterator<char>());
+    }
+
+    ~FileView() {
+#ifdef LTL2PROP_HAS_MMAP
+      if (mapped_data != nullptr) {
+        ::munmap(const_cast<char*>(mapped_data), mapped_size);
+      }
+#endif
+    }
+
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+
+    const char* begin() const {
+      return mapped_data != nullptr ? mapped_data : content.data();
+    }
+
+    const char* end() const {
+      return mapped_data != nullptr ? mapped_data + mapped_size
+                                    : content.data() + content.size();
+    }
+
+   private:
+    const char* mapped_data = nullptr;
+    std::size_t mapped_size = 0;
+    std::string content;
+  };
+
+  /**
+   * @brief lna-info as read by a backend, possibly a shard manifest
+   */
+  struct ParsedNet {
+    Net net;
+    // true when the "functions" key is present
+    bool has_functions = false;
+    // true when the "shards" key is present
+    bool is_manifest = false;
+    // shards of a manifest: smart contract and path
+    std::vector<std::pair<std::string, std::string>> shards;
+  };
+
+  ParsedNet parse_dom(const char* begin, const char* end, const NetScope& scope) {
+    LTL2PROP_MEMORY_PHASE(JsonDom);
+    nlohmann::json lna_json;
+    if (scope.whole_net) {
+      lna_json = nlohmann::json::parse(begin, end);
+    }
+    else {
+      // discard the statements outside of the scope as soon as they are parsed,
+      // so they are never stored in the resulting json object
+      std::string top_level_key;
+      nlohmann::json::parser_callback_t skip_statements =
+          [&](int depth, nlohmann::json::parse_event_t event, nlohmann::json& parsed) {
+            if (depth == 1 && event == nlohmann::json::parse_event_t::key) {
+              top_level_key = parsed;
+            }
+            else if (depth == 2 && event == nlohmann::json::parse_event_t::object_end &&
+                     top_level_key == "statements") {
+              return scope.contains(statement_from_json(parsed));
+            }
+            else if (depth == 2 && event == nlohmann::json::parse_event_t::object_end && scope.calls_only) {
+              return false;
+            }
+            return true;
+          };
+      lna_json = nlohmann::json::parse(begin, end, skip_statements);
+    }
+
+    ParsedNet parsed_net;
+    parsed_net.has_functions = lna_json.contains("functions");
+    parsed_net.is_manifest = lna_json.contains("shards");
+    for (const auto& shard : lna_json.value("shards", nlohmann::json::array())) {
+      parsed_net.shards.push_back({shard.at("smart_contract"), shard.at("path")});
+    }
+
+    // manifests and shards may leave out some of the lists
+    for (const char* key : {"global_variables", "functions", "statements"}) {
+      if (!lna_json.contains(key)) lna_json[key] = nlohmann::json::array();
+    }
+    LTL2PROP_MEMORY_PHASE(StatementStore);
+    parsed_net.net = net_from_json(lna_json);
+    return parsed_net;
+  }
+
+  // fields every element of a list must have, as read by net_from_json() and
+  // parse_dom(); the other lists have no required field
+  const std::vector<std::string>& required_fields(const std::string& section) {
+    static const std::map<std::string, std::vector<std::string>> fields = {
+      {"statements", {"type", "smart_contract", "parent", "variable", "function", "input_place",
+                      "output_place", "param_place", "right_hand_variables", "timestamp"}},
+      {"global_variables", {"name"}},
+      {"functions", {"name", "smart_contract", "local_variables"}},
+      {"shards", {"smart_contract", "path"}},
+      {"places", {"name", "capacity"}},
+      {"local_variables", {"name", "place"}},
+    };
+    static const std::vector<std::string> no_fields;
+    auto section_fields = fields.find(section);
+    return section_fields == fields.end() ? no_fields : section_fields->second;
+  }
+
+  /**
+   * @brief SAX handler reading an lna-info straight into a net
+   *
+   * Depths count the open containers: the root object is at depth 1, its
+   * lists at depth 2, their elements at depth 3, and the local variables of
+   * functions at depth 5. An element lacking a required field is rejected,
+   * like the DOM backend does.
+   */
+  class NetSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+   public:
+    NetSaxHandler(ParsedNet& _parsed_net, const NetScope& _scope)
+        : parsed_net(_parsed_net), scope(_scope) {}
+
+    bool null() override { return true; }
+    bool number_float(number_float_t, const string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+
+    bool number_integer(number_integer_t value) override {
+      if (depth == 3 && section == "places" && field == "capacity") capacity = static_cast<unsigned>(value);
+      return true;
+    }
+
+    bool number_unsigned(number_unsigned_t value) override {
+      if (depth == 3 && section == "places" && field == "capacity") capacity = static_cast<unsigned>(value);
+      return true;
+    }
+
+    bool boolean(bool value) override {
+      if (depth == 3 && section == "statements" && field == "timestamp") {
+        statement.timestamp = value;
+      }
+      return true;
+    }
+
+    bool string(string_t& value) override {
+      if (depth == 2 && section == "entry_points") {
+        parsed_net.net.entry_points.push_back(std::move(value));
+      }
+      else if (depth == 3) {
+        if (section == "statements") set_statement_field(value);
+        else if (section == "global_variables" && field == "name") global_variable = std::move(value);
+        else if (section == "functions" && field == "name") function = std::move(value);
+        else if (section == "functions" && field == "smart_contract") smart_contract = std::move(value);
+        else if (section == "shards" && field == "smart_contract") shard.first = std::move(value);
+        else if (section == "shards" && field == "path") shard.second = std::move(value);
+        else if (section == "places" && field == "name") place = std::move(value);
+      }
+      else if (depth == 4 && section == "statements" && field == "right_hand_variables") {
+        statement.RHV.push_back(std::move(value));
+      }
+      else if (depth == 5 && section == "functions" && field == "local_variables") {
+        if (local_variable_field == "name") local_variable.name = std::move(value);
+        if (local_variable_field == "place") local_variable.place = std::move(value);
+      }
+      return true;
+    }
+
+    bool start_object(std::size_t) override {
+      ++depth;
+      if (depth == 3) {
+        statement = Statement();
+        statement.timestamp = false;
+        global_variable.clear();
+        function.clear();
+        smart_contract.clear();
+        local_variables.clear();
+        shard = {};
+        place.clear();
+        capacity = 0;
+      }
+      if (depth == 3) seen_fields = 0;
+      if (depth == 5) {
+        local_variable = LocalVariable();
+        seen_local_variable_fields = 0;
+      }
+      return true;
+    }
+
+    bool key(string_t& value) override {
+      if (depth == 1) {
+        section = value;
+        section_fields = &required_fields(section);
+        if (section == "functions") parsed_net.has_functions = true;
+        if (section == "shards") parsed_net.is_manifest = true;
+      }
+      if (depth == 3) {
+        field = value;
+        seen_fields |= field_bit(*section_fields, field);
+      }
+      if (depth == 5) {
+        local_variable_field = value;
+        seen_local_variable_fields |= field_bit(required_fields("local_variables"), local_variable_field);
+      }
+      return true;
+    }
+
+    bool end_object() override {
+      if (depth == 5 && section == "functions" && field == "local_variables") {
+        if (!has_fields("local_variables", seen_local_variable_fields)) return false;
+        local_variables.push_back(std::move(local_variable));
+      }
+      else if (depth == 3) {
+        // elements dropped by a calls-only read are not checked, as with the DOM backend
+        if ((section == "statements" || !scope.calls_only) && !has_fields(section, seen_fields)) return false;
+        end_element();
+      }
+      --depth;
+      return true;
+    }
+
+    bool start_array(std::size_t) override {
+      ++depth;
+      return true;
+    }
+
+    bool end_array() override {
+      --depth;
+      return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+      error = ex.what();
+      return false;
+    }
+
+    // message of the parse error, if any
+    std::string error;
+
+   private:
+    // bit of a field in the required fields of its list, 0 for the other fields
+    static unsigned field_bit(const std::vector<std::string>& fields, const std::string& name) {
+      for (std::size_t i = 0; i < fields.size(); ++i) {
+        if (fields[i] == name) return 1u << i;
+      }
+      return 0;
+    }
+
+    // check that an element has all the required fields of its list
+    bool has_fields(const std::string& list, unsigned seen) {
+      const std::vector<std::string>& fields = required_fields(list);
+      for (std::size_t i = 0; i < fields.size(); ++i) {
+        if ((seen & (1u << i)) == 0) {
+          error = "an element of " + list + " lacks its " + fields[i] + " field";
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void set_statement_field(string_t& value) {
+      if (field == "type") statement.type = std::move(value);
+      else if (field == "smart_contract") statement.smart_contract = std::move(value);
+      else if (field == "parent") statement.parent = std::move(value);
+      else if (field == "variable") statement.variable = std::move(value);
+      else if (field == "function") statement.function_name = std::move(value);
+      else if (field == "input_place") statement.input_place = std::move(value);
+      else if (field == "output_place") statement.output_place = std::move(value);
+      else if (field == "param_place") statement.param_place = std::move(value);
+    }
+
+    void end_element() {
+      Net& net = parsed_net.net;
+      if (section == "statements") {
+        if (scope.contains(statement)) net.statements.push_back(std::move(statement));
+      }
+      else if (scope.calls_only) {
+        return;
+      }
+      else if (section == "global_variables") {
+        net.global_variables.push_back(std::move(global_variable));
+      }
+      // the function's name may come after its local variables
+      else if (section == "functions") {
+        for (auto& variable : local_variables) {
+          variable.smart_contract = smart_contract;
+          variable.function = function;
+          net.local_variables.push_back(std::move(variable));
+        }
+      }
+      else if (section == "shards") {
+        parsed_net.shards.push_back(std::move(shard));
+      }
+      else if (section == "places") {
+        net.place_capacities[place] = capacity;
+      }
+    }
+
+    ParsedNet& parsed_net;
+    const NetScope& scope;
+
+    int depth = 0;
+    std::string section, field, local_variable_field;
+    const std::vector<std::string>* section_fields = &required_fields("");
+
+    // required fields read so far, one bit per field of required_fields()
+    unsigned seen_fields = 0, seen_local_variable_fields = 0;
+
+    // element being read
+    Statement statement;
+    std::string global_variable, function, smart_contract;
+    LocalVariable local_variable;
+    std::vector<LocalVariable> local_variables;
+    std::pair<std::string, std::string> shard;
+    std::string place;
+    unsigned capacity = 0;
+  };
+
+  ParsedNet parse_sax(const char* begin, const char* end, const NetScope& scope) {
+    LTL2PROP_MEMORY_PHASE(StatementStore);
+    ParsedNet parsed_net;
+    NetSaxHandler handler(parsed_net, scope);
+    if (!nlohmann::json::sax_parse(begin, end, &handler)) {
+      throw std::runtime_error("Could not parse lna-info: " + handler.error);
+    }
+    return parsed_net;
+  }
+
+  ParsedNet parse_range(const char* begin, const char* end, const NetScope& scope, JsonBackend backend) {
+    LTL2PROP_TRACE_SCOPE(__func__, "load", json_backend_name(backend));
+    return backend == JsonBackend::Sax ? parse_sax(begin, end, scope) : parse_dom(begin, end, scope);
+  }
+
+  // directory part of a path, with its trailing separator
+  std::string parent_directory(const std::string& filename) {
+    std::size_t separator = filename.find_last_of('/');
+    return separator == std::string::npos ? "" : filename.substr(0, separator + 1);
+  }
+
+  // merge the shards of the contracts referenced by the scope into one net
+  Net load_shards(ParsedNet& manifest, const std::string& directory,
+                  const NetScope& scope, JsonBackend backend) {
+    Net net = std::move(manifest.net);
+
+    // local variables are read from the shards unless the manifest lists them
+    bool functions_in_shards = !manifest.has_functions;
+
+    for (const auto& shard : manifest.shards) {
+      bool referenced = scope.references(shard.first) || (scope.all_functions && functions_in_shards);
+      // the other shards only add their unscoped statements, i.e. the call
+      // sites, and their entry points to the call graph
+      if (!referenced && scope.unscoped_types.empty()) continue;
+      NetScope shard_scope = scope;
+      shard_scope.calls_only = !referenced;
+
+      std::string path = shard.second;
+      if (path.empty() || path[0] != '/') path = directory + path;
+      FileView view(path);
+      ParsedNet shard_net = parse_range(view.begin(), view.end(), shard_scope, backend);
+      if (!functions_in_shards) shard_net.net.local_variables.clear();
+      net.append(std::move(shard_net.net));
+    }
+    return net;
+  }
+
+  // hash of an lna-info, and of all of its shards if it is a manifest
+  std::string hash_net(const std::string& filename, const char* begin, const char* end) {
+    std::string digests = content_hash(begin, end);
+
+    // only a file naming shards is parsed, without keeping any statement
+    static const std::string shards_key = "\"shards\"";
+    if (std::search(begin, end, shards_key.begin(), shards_key.end()) == end) return digests;
+    NetScope no_statement;
+    no_statement.whole_net = false;
+    ParsedNet manifest = parse_range(begin, end, no_statement, JsonBackend::Sax);
+    if (!manifest.is_manifest) return digests;
+
+    for (const auto& shard : manifest.shards) {
+      std::string path = shard.second;
+      if (path.empty() || path[0] != '/') path = parent_directory(filename) + path;
+      FileView view(path);
+      digests += ' ' + shard.first + ' ' + content_hash(view.begin(), view.end());
+    }
+    return content_hash(digests);
+  }
+
+  }  // namespace
+
+  bool NetScope::contains(const Statement& statement) const {
+    if (whole_net) return true;
+
+    if (unscoped_types.find(statement.type) != unscoped_types.end()) return true;
+
+    auto contract = contracts.find(statement.smart_contract);
+    if (contract == contracts.end()) return false;
+
+    // statements are matched on both their parent and their function field
+    // since queries use one or the other
+    const std::set<std::string>& functions = contract->second;
+    return functions.empty() ||
+           functions.count(statement.parent) > 0 ||
+           functions.count(statement.function_name) > 0;
+  }
+
+  JsonBackend default_json_backend() {
+    return json_backend_from_name(LTL2PROP_DEFAULT_JSON_BACKEND);
+  }
+
+  JsonBackend json_backend_from_name(const std::string& name) {
+    if (name == "dom") return JsonBackend::Dom;
+    if (name == "sax") return JsonBackend::Sax;
+    throw std::invalid_argument("JSON backend " + name + " is not handled by LTLTranslator");
+  }
+
+  std::string json_backend_name(JsonBackend backend) {
+    return backend == JsonBackend::Sax ? "sax" : "dom";
+  }
+
+  NetScope formula_scope(const nlohmann::json& ltl_json) {
+    NetScope scope;
+    std::string formula_type = ltl_json.value("type", "");
+    if (!ltl_json.contains("params")) return scope;
+    const nlohmann::json& formula_params = ltl_json.at("params");
+    std::string template_name = formula_params.value("name", "");
+    nlohmann::json inputs = formula_params.value("inputs", nlohmann::json::object());
+
+    std::string smart_contract = inputs.value("smart_contract", "");
+    std::string function = inputs.value("selected_function", "");
+    std::string rival_contract = inputs.value("rival_contract", "");
+
+    if (formula_type == "general") {
+      // properties on a variable value never look at statements
+      if (template_name == "Integer Overflow/Underflow") {
+        scope.whole_net = false;
+        scope.all_functions = true;
+      }
+      // the rival contract is searched for selfdestruct calls, and the whole
+      // smart contract for calls to 'function'; their callers are found in
+      // the call graph of the net
+      else if (template_name == "Self Destruction") {
+        scope.whole_net = false;
+        if (rival_contract.empty()) {
+          scope.contracts[smart_contract].insert(function);
+        }
+        else {
+          scope.unscoped_types.insert("function_call");
+          scope.contracts[smart_contract].clear();
+          scope.contracts[rival_contract].clear();
+        }
+      }
+      else if (template_name == "Skip Empty String Literal") {
+        scope.whole_net = false;
+        scope.contracts[smart_contract].insert(function);
+      }
+      // "Uninitialized Storage Variable" reads statements of every contract,
+      // "Reentrancy" and "Timestamp Dependance" follow the callees of the
+      // function into any contract
+    }
+    else if (formula_type == "specific") {
+      if (template_name == "Variable Always Less Than" ||
+          template_name == "Variable Always Bigger Than" ||
+          template_name == "Variable Always Equal To") {
+        scope.whole_net = false;
+        scope.all_functions = true;
+      }
+      // function templates look for call sites in the whole contracts, and
+      // for their callers in the call graph of the net
+      else if (!template_name.empty()) {
+        scope.whole_net = false;
+        scope.unscoped_types.insert("function_call");
+        scope.contracts[smart_contract].clear();
+        if (inputs.contains("rival_contract")) {
+          scope.contracts[rival_contract].clear();
+        }
+      }
+    }
+    // a custom property is given in Helena syntax, no statement is needed
+    else {
+      scope.whole_net = false;
+    }
+    return scope;
+  }
+
+  bool NetScope::references(const std::string& smart_contract) const {
+    return whole_net || contracts.find(smart_contract) != contracts.end();
+  }
+
+  Net parse_net(const std::string& content, const NetScope& scope, JsonBackend backend) {
+    return parse_range(content.data(), content.data() + content.size(), scope, backend).net;
+  }
+
+  Net load_net(const std::string& filename, const NetScope& scope, JsonBackend backend) {
+    LTL2PROP_TRACE_SCOPE(__func__, "load", filename);
+    ParsedNet parsed_net;
+    {
+      FileView view(filename);
+      parsed_net = parse_range(view.begin(), view.end(), scope, backend);
+    }
+
+    // a manifest only lists the shards to be read
+    if (parsed_net.is_manifest) {
+      return load_shards(parsed_net, parent_directory(filename), scope, backend);
+    }
+    return std::move(parsed_net.net);
+  }
+
+  std::string read_net_file(const std::string& filename) {
+    LTL2PROP_TRACE_SCOPE(__func__, "load", filename);
+    FileView view(filename);
+    return std::string(view.begin(), view.end());
+  }
+
+  Net parse_net_file(const std::string& filename, const std::string& content,
+                     const NetScope& scope, JsonBackend backend) {
+    LTL2PROP_TRACE_SCOPE(__func__, "load", filename);
+    ParsedNet parsed_net = parse_range(content.data(), content.data() + content.size(), scope, backend);
+    if (parsed_net.is_manifest) {
+      return load_shards(parsed_net, parent_directory(filename), scope, backend);
+    }
+    return std::move(parsed_net.net);
+  }
+
+  std::string net_file_hash(const std::string& filename) {
+    LTL2PROP_TRACE_SCOPE(__func__, "load", filename);
+    FileView view(filename);
+    return hash_net(filename, view.begin(), view.end());
+  }
+
+  std::string net_content_hash(const std::string& filename, const std::string& content) {
+    LTL2PROP_TRACE_SCOPE(__func__, "load", filename);
+    return hash_net(filename, content.data(), content.data() + content.size());
+  }
+
+}  // namespace LTL2PROP
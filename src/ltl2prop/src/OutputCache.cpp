@@ -0,0 +1,97 @@
+#include "OutputCache.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include "IncrementalIndex.hpp"
+#include "LTLtranslator.hpp"
+#include "Trace.hpp"
+#include "json.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define LTL2PROP_HAS_GETPID 1
+#endif
+
+namespace LTL2PROP {
+
+  namespace {
+
+  // to be increased whenever the layout of the entries changes
+  const char cache_format[] = "ltl2prop-cache-1";
+
+  // temporary files written by this process
+  std::atomic<unsigned> temporary_files{0};
+
+  std::string process_id() {
+#ifdef LTL2PROP_HAS_GETPID
+    return std::to_string(::getpid());
+#else
+    return "0";
+#endif
+  }
+
+  }  // namespace
+
+  OutputCache::OutputCache(const std::string& _directory) : directory(_directory) {
+    if (!directory.empty() && directory.back() != '/') directory += '/';
+  }
+
+  std::string OutputCache::key(const std::string& net_hash, const nlohmann::json& ltl_json,
+                               const std::string& options) {
+    // the dump of a JSON object lists its keys in order, without whitespace;
+    // entries written by another version of the translation are never found
+    return content_hash(std::string(cache_format) + '\x1f' + std::to_string(translation_version) +
+                        '\x1f' + net_hash + '\x1f' + ltl_json.dump() +
+                        '\x1f' + options);
+  }
+
+  bool OutputCache::lookup(const std::string& key, std::map<std::string, std::string>& outputs) const {
+    LTL2PROP_TRACE_SCOPE(__func__, "load", key);
+    std::ifstream entry_stream(directory + key + ".entry", std::ios::binary | std::ios::ate);
+    if (!entry_stream) return false;
+    std::string content(static_cast<std::size_t>(entry_stream.tellg()), '\0');
+    entry_stream.seekg(0);
+    if (!entry_stream.read(&content[0], content.size())) return false;
+
+    // frames: #<output> <length>\n<content>, an entry that cannot be read is a miss
+    std::map<std::string, std::string> entry;
+    std::size_t position = 0;
+    while (position < content.size()) {
+      std::size_t line_end = content.find('\n', position);
+      std::size_t space = content.rfind(' ', line_end);
+      if (content[position] != '#' || line_end == std::string::npos || space == std::string::npos ||
+          space <= position) {
+        return false;
+      }
+      std::size_t length = std::strtoull(content.c_str() + space + 1, nullptr, 10);
+      if (length > content.size() - line_end - 1) return false;
+      entry[content.substr(position + 1, space - position - 1)] = content.substr(line_end + 1, length);
+      position = line_end + 1 + length;
+    }
+    if (entry.count("property") == 0 || entry.count("propositions") == 0) return false;
+    outputs.swap(entry);
+    return true;
+  }
+
+  void OutputCache::store(const std::string& key, const std::map<std::string, std::string>& outputs) const {
+    LTL2PROP_TRACE_SCOPE(__func__, "write", key);
+    std::string filename = directory + key + ".entry";
+    std::string temporary = filename + ".tmp." + process_id() + "." + std::to_string(temporary_files++);
+    {
+      std::ofstream entry_stream(temporary, std::ios::binary);
+      for (const auto& output : outputs) {
+        entry_stream << '#' << output.first << ' ' << output.second.size() << '\n' << output.second;
+      }
+      entry_stream.close();
+      if (entry_stream.fail()) {
+        std::remove(temporary.c_str());
+        return;
+      }
+    }
+    // a cache that cannot be written only costs the next run a translation
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) std::remove(temporary.c_str());
+  }
+
+}  // namespace LTL2PROP
@@ -0,0 +1,177 @@
+#include "TaskScheduler.hpp"
+
+#include <utility>
+
+namespace LTL2PROP {
+
+  namespace {
+
+  // index of the worker running the current thread
+  thread_local int worker_index = -1;
+
+  }  // namespace
+
+  TaskScheduler::TaskScheduler(unsigned workers) {
+    if (workers == 0) workers = 1;
+    for (unsigned worker = 0; worker < workers; ++worker) {
+      queues.emplace_back(new WorkerQueue());
+    }
+    for (unsigned worker = 0; worker < workers; ++worker) {
+      threads.emplace_back(&TaskScheduler::run, this, worker);
+    }
+  }
+
+  TaskScheduler::~TaskScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) thread.join();
+  }
+
+  unsigned TaskScheduler::worker_count() const {
+    return static_cast<unsigned>(queues.size());
+  }
+
+  int TaskScheduler::current_worker() {
+    return worker_index;
+  }
+
+  void TaskScheduler::spawn(Task task) {
+    ++pending;
+    // a worker keeps its own tasks, the others are dealt in turn
+    unsigned worker = worker_index >= 0 && static_cast<unsigned>(worker_index) < queues.size()
+                          ? static_cast<unsigned>(worker_index)
+                          : next_queue++ % queues.size();
+    {
+      std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+      queues[worker]->tasks.push_back(std::move(task));
+    }
+    ++queued;
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    wake.notify_one();
+  }
+
+  void TaskScheduler::wait() {
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    idle.wait(lock, [this] { return pending == 0; });
+    if (error) {
+      std::exception_ptr task_error = error;
+      error = nullptr;
+      std::rethrow_exception(task_error);
+    }
+  }
+
+  bool TaskScheduler::pop(unsigned worker, Task& task) {
+    WorkerQueue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+  }
+
+  bool TaskScheduler::steal(unsigned thief, Task& task) {
+    for (std::size_t i = 1; i < queues.size(); ++i) {
+      WorkerQueue& queue = *queues[(thief + i) % queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.tasks.empty()) continue;
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+    return false;
+  }
+
+  void TaskScheduler::run(unsigned worker) {
+    worker_index = static_cast<int>(worker);
+    while (true) {
+      Task task;
+      if (pop(worker, task) || steal(worker, task)) {
+        --queued;
+        try {
+          task();
+        }
+        catch (...) {
+          std::lock_guard<std::mutex> lock(sleep_mutex);
+          if (!error) error = std::current_exception();
+        }
+        if (--pending == 0) {
+          std::lock_guard<std::mutex> lock(sleep_mutex);
+          idle.notify_all();
+        }
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      wake.wait(lock, [this] { return stopping || queued > 0; });
+      if (stopping && queued <= 0) return;
+    }
+  }
+
+  TaskGroup::TaskGroup(TaskScheduler& _scheduler)
+      : scheduler(_scheduler), state(std::make_shared<State>()) {}
+
+  TaskGroup::~TaskGroup() {
+    // subtasks not started when the group is left without wait() are dropped
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->tasks.clear();
+    state->done.wait(lock, [this] { return state->running == 0; });
+  }
+
+  void TaskGroup::spawn(TaskScheduler::Task task) {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->tasks.push_back(std::move(task));
+    }
+    // the scheduler gets a ticket, whoever runs it first runs the subtask
+    std::shared_ptr<State> group_state = state;
+    scheduler.spawn([group_state] { run_one(group_state, false); });
+  }
+
+  void TaskGroup::wait() {
+    while (run_one(state, true)) {}
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [this] { return state->tasks.empty() && state->running == 0; });
+    if (state->error) {
+      std::exception_ptr task_error = state->error;
+      state->error = nullptr;
+      std::rethrow_exception(task_error);
+    }
+  }
+
+  bool TaskGroup::run_one(const std::shared_ptr<State>& state, bool newest) {
+    TaskScheduler::Task task;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->tasks.empty()) return false;
+      if (newest) {
+        task = std::move(state->tasks.back());
+        state->tasks.pop_back();
+      }
+      else {
+        task = std::move(state->tasks.front());
+        state->tasks.pop_front();
+      }
+      ++state->running;
+    }
+
+    std::exception_ptr task_error;
+    try {
+      task();
+    }
+    catch (...) {
+      task_error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (task_error && !state->error) state->error = task_error;
+    if (--state->running == 0 && state->tasks.empty()) state->done.notify_all();
+    return true;
+  }
+
+}  // namespace LTL2PROP
@@ -0,0 +1,107 @@
+#include "Trace.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "json.hpp"
+
+namespace LTL2PROP {
+
+  namespace {
+
+  struct TraceEvent {
+    const char* name;
+    const char* category;
+    std::string detail;
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::time_point end;
+    unsigned thread;
+  };
+
+  /**
+   * @brief Spans recorded by the open session, shared by all threads
+   */
+  struct TraceRecorder {
+    std::atomic<bool> recording{false};
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point origin;
+    std::vector<TraceEvent> events;
+    // small thread numbers, in order of first span
+    std::map<std::thread::id, unsigned> threads;
+  };
+
+  TraceRecorder& recorder() {
+    static TraceRecorder trace_recorder;
+    return trace_recorder;
+  }
+
+  double microseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  }
+
+  }  // namespace
+
+  TraceSession::TraceSession(const std::string& _filename) : filename(_filename) {
+    TraceRecorder& trace_recorder = recorder();
+    std::lock_guard<std::mutex> lock(trace_recorder.mutex);
+    trace_recorder.events.clear();
+    trace_recorder.threads.clear();
+    trace_recorder.origin = std::chrono::steady_clock::now();
+    trace_recorder.recording = true;
+  }
+
+  TraceSession::~TraceSession() {
+    TraceRecorder& trace_recorder = recorder();
+    std::lock_guard<std::mutex> lock(trace_recorder.mutex);
+    trace_recorder.recording = false;
+
+    nlohmann::json trace_events = nlohmann::json::array();
+    for (const auto& event : trace_recorder.events) {
+      nlohmann::json trace_event = {
+        {"name", event.name},
+        {"cat", event.category},
+        {"ph", "X"},
+        {"ts", microseconds(event.begin - trace_recorder.origin)},
+        {"dur", microseconds(event.end - event.begin)},
+        {"pid", 1},
+        {"tid", event.thread},
+      };
+      if (!event.detail.empty()) {
+        trace_event["args"] = {{"detail", event.detail}};
+      }
+      trace_events.push_back(trace_event);
+    }
+
+    std::ofstream trace_stream(filename);
+    trace_stream << nlohmann::json({{"traceEvents", trace_events}, {"displayTimeUnit", "ms"}}).dump()
+                 << std::endl;
+  }
+
+  bool TraceSession::is_recording() {
+    return recorder().recording;
+  }
+
+  TraceSpan::TraceSpan(const char* _name, const char* _category, const std::string& _detail)
+      : name(_name), category(_category), recording(TraceSession::is_recording()) {
+    if (!recording) return;
+    detail = _detail;
+    begin = std::chrono::steady_clock::now();
+  }
+
+  TraceSpan::~TraceSpan() {
+    if (!recording) return;
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    TraceRecorder& trace_recorder = recorder();
+    std::lock_guard<std::mutex> lock(trace_recorder.mutex);
+    if (!trace_recorder.recording) return;
+    auto thread = trace_recorder.threads.emplace(std::this_thread::get_id(),
+                                                 trace_recorder.threads.size() + 1).first;
+    trace_recorder.events.push_back({name, category, std::move(detail), begin, end, thread->second});
+  }
+
+}  // namespace LTL2PROP
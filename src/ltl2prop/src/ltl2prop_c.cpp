@@ -0,0 +1,144 @@
+#include "ltl2prop_c.h"
+
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include "LTLtranslator.hpp"
+#include "NetLoader.hpp"
+#include "json.hpp"
+
+struct ltl2prop_net {
+  // the translator keeps the net and the query results of past translations
+  std::unique_ptr<LTL2PROP::LTLTranslator> translator;
+};
+
+struct ltl2prop_result {
+  std::string property;
+  std::string propositions;
+};
+
+namespace {
+
+// message of the last error of each thread
+thread_local std::string last_error;
+
+/**
+ * Record the message of a failure
+ *
+ * @param status reason of the failure
+ * @param message message returned by ltl2prop_last_error()
+ * @return status
+ */
+ltl2prop_status fail(ltl2prop_status status, const std::string& message) {
+  last_error = message;
+  return status;
+}
+
+/**
+ * Wrap a loaded net into a handle
+ *
+ * @param loaded net read from the lna-info
+ * @param net set to the handle
+ */
+void make_handle(const LTL2PROP::Net& loaded, ltl2prop_net** net) {
+  std::unique_ptr<ltl2prop_net> handle(new ltl2prop_net());
+  handle->translator.reset(new LTL2PROP::LTLTranslator(loaded, nlohmann::json::object()));
+  *net = handle.release();
+}
+
+}  // namespace
+
+extern "C" {
+
+int ltl2prop_api_version(void) {
+  return LTL2PROP_C_API_VERSION;
+}
+
+const char* ltl2prop_last_error(void) {
+  return last_error.c_str();
+}
+
+ltl2prop_status ltl2prop_net_load_file(const char* path, ltl2prop_net** net) {
+  if (path == nullptr || net == nullptr) {
+    return fail(LTL2PROP_INVALID_ARGUMENT, "ltl2prop_net_load_file: path and net are required");
+  }
+  try {
+    make_handle(LTL2PROP::load_net(path), net);
+    return LTL2PROP_OK;
+  }
+  catch (const std::exception& e) {
+    return fail(LTL2PROP_NET_ERROR, e.what());
+  }
+  // no exception may unwind through a C caller
+  catch (...) {
+    return fail(LTL2PROP_NET_ERROR, "ltl2prop_net_load_file: unknown exception");
+  }
+}
+
+ltl2prop_status ltl2prop_net_load_buffer(const char* data, size_t size, ltl2prop_net** net) {
+  if (data == nullptr || net == nullptr) {
+    return fail(LTL2PROP_INVALID_ARGUMENT, "ltl2prop_net_load_buffer: data and net are required");
+  }
+  try {
+    make_handle(LTL2PROP::parse_net(std::string(data, size)), net);
+    return LTL2PROP_OK;
+  }
+  catch (const std::exception& e) {
+    return fail(LTL2PROP_NET_ERROR, e.what());
+  }
+  catch (...) {
+    return fail(LTL2PROP_NET_ERROR, "ltl2prop_net_load_buffer: unknown exception");
+  }
+}
+
+void ltl2prop_net_free(ltl2prop_net* net) {
+  delete net;
+}
+
+ltl2prop_status ltl2prop_translate(ltl2prop_net* net, const char* formula, size_t size,
+                                   ltl2prop_result** result) {
+  if (net == nullptr || formula == nullptr || result == nullptr) {
+    return fail(LTL2PROP_INVALID_ARGUMENT, "ltl2prop_translate: net, formula and result are required");
+  }
+  try {
+    nlohmann::json ltl_json = nlohmann::json::parse(formula, formula + size);
+    std::map<std::string, std::string> translation = net->translator->translate(ltl_json);
+
+    std::unique_ptr<ltl2prop_result> handle(new ltl2prop_result());
+    handle->property = std::move(translation["property"]);
+    handle->propositions = std::move(translation["propositions"]);
+    *result = handle.release();
+    return LTL2PROP_OK;
+  }
+  catch (const std::exception& e) {
+    return fail(LTL2PROP_TRANSLATION_ERROR, e.what());
+  }
+  catch (...) {
+    return fail(LTL2PROP_TRANSLATION_ERROR, "ltl2prop_translate: unknown exception");
+  }
+}
+
+const char* ltl2prop_result_property(const ltl2prop_result* result, size_t* size) {
+  if (result == nullptr) {
+    if (size != nullptr) *size = 0;
+    return nullptr;
+  }
+  if (size != nullptr) *size = result->property.size();
+  return result->property.c_str();
+}
+
+const char* ltl2prop_result_propositions(const ltl2prop_result* result, size_t* size) {
+  if (result == nullptr) {
+    if (size != nullptr) *size = 0;
+    return nullptr;
+  }
+  if (size != nullptr) *size = result->propositions.size();
+  return result->propositions.c_str();
+}
+
+void ltl2prop_result_free(ltl2prop_result* result) {
+  delete result;
+}
+
+}  // extern "C"
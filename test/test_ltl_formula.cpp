@@ -0,0 +1,185 @@
+#include "LtlFormula.hpp"
+#include <CLI11.hpp>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Parse a formula and write it back fully parenthesized
+ *
+ * @param formula text of the formula, without the property header
+ * @return text of the parsed formula, or the parse error
+ */
+std::string parsed(const std::string& formula) {
+  try {
+    return LTL2PROP::to_string(LTL2PROP::parse_ltl_property("ltl property p: " + formula + ";").formula);
+  }
+  catch (const std::runtime_error& e) {
+    return std::string("error: ") + e.what();
+  }
+}
+
+/**
+ * Simplify a formula with the constant propositions t (true) and f (false)
+ *
+ * @param formula text of the formula, without the property header
+ * @return text of the simplified formula, or the parse error
+ */
+std::string simplified(const std::string& formula) {
+  try {
+    LTL2PROP::LtlFormula parsed_formula = LTL2PROP::parse_ltl_property("ltl property p: " + formula + ";").formula;
+    return LTL2PROP::to_string(LTL2PROP::simplify(parsed_formula, {{"t", true}, {"f", false}}));
+  }
+  catch (const std::runtime_error& e) {
+    return std::string("error: ") + e.what();
+  }
+}
+
+/**
+ * Name a verdict
+ *
+ * @param verdict the verdict
+ * @return holds, violated or undecided
+ */
+std::string verdict_name(LTL2PROP::Verdict verdict) {
+  return verdict == LTL2PROP::Verdict::Holds      ? "holds"
+         : verdict == LTL2PROP::Verdict::Violated ? "violated"
+                                                  : "undecided";
+}
+
+/**
+ * Compare the results of a function with the expected ones
+ *
+ * @param test name of the test
+ * @param function function under test
+ * @param cases input and expected result of each case
+ * @return true if every case passed
+ */
+bool check(const std::string& test, const std::function<std::string(const std::string&)>& function,
+           const std::vector<std::pair<std::string, std::string>>& cases) {
+  bool passed = true;
+  for (const auto& test_case : cases) {
+    std::string result = function(test_case.first);
+    if (result != test_case.second) {
+      std::cout << test << ": FAILED, " << test_case.first << "\n"
+                << "  expected " << test_case.second << "\n"
+                << "  got      " << result << std::endl;
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+int main(int argc, char **argv) {
+  CLI::App app{"LTLTranslator LTL formula test"};
+
+  std::string TEST;
+  app.add_option("--test", TEST, "Part to be tested: precedence, simplify or verdict")
+      ->required();
+
+  CLI11_PARSE(app, argc, argv);
+
+  bool passed;
+  if (TEST == "precedence") {
+    // not, [], <>, until, and, or, =>, from the tightest to the loosest
+    passed = check(TEST, parsed, {
+      {"a", "a"},
+      {"not a and b", "(not (a)) and (b)"},
+      {"[] a or b", "([] (a)) or (b)"},
+      {"<> a until b", "(<> (a)) until (b)"},
+      {"not [] <> a", "not ([] (<> (a)))"},
+      {"a until b and c", "((a) until (b)) and (c)"},
+      {"a and b until c", "(a) and ((b) until (c))"},
+      {"a and b or c", "((a) and (b)) or (c)"},
+      {"a or b and c", "(a) or ((b) and (c))"},
+      {"a or b => c", "((a) or (b)) => (c)"},
+      {"a => b or c", "(a) => ((b) or (c))"},
+      // until and => group to the right, and and or to the left
+      {"a until b until c", "(a) until ((b) until (c))"},
+      {"a => b => c", "(a) => ((b) => (c))"},
+      {"a and b and c", "((a) and (b)) and (c)"},
+      {"a or b or c", "((a) or (b)) or (c)"},
+      {"not (a or b)", "not ((a) or (b))"},
+      {"[] ( ( a ) => <> ( b ) )", "[] ((a) => (<> (b)))"},
+      {"true or false", "(true) or (false)"},
+      {"funcall.p_1 or x", "(funcall.p_1) or (x)"},
+    });
+  }
+  else if (TEST == "simplify") {
+    passed = check(TEST, simplified, {
+      // constant propositions
+      {"t", "true"},
+      {"f", "false"},
+      {"p", "p"},
+      // not
+      {"not t", "false"},
+      {"not f", "true"},
+      // [] and <>
+      {"[] t", "true"},
+      {"[] f", "false"},
+      {"<> t", "true"},
+      {"<> f", "false"},
+      // until
+      {"p until t", "true"},
+      {"p until f", "false"},
+      {"f until p", "p"},
+      {"t until p", "<> (p)"},
+      {"p until q", "(p) until (q)"},
+      // and, or
+      {"p and f", "false"},
+      {"f and p", "false"},
+      {"p and t", "p"},
+      {"t and p", "p"},
+      {"p or t", "true"},
+      {"t or p", "true"},
+      {"p or f", "p"},
+      {"f or p", "p"},
+      // =>
+      {"f => p", "true"},
+      {"p => t", "true"},
+      {"t => p", "p"},
+      {"p => f", "not (p)"},
+      {"p => q", "(p) => (q)"},
+      // constants are propagated from the leaves
+      {"[] (f => <> p)", "true"},
+      {"[] ((p or f) => <> (q and t))", "[] ((p) => (<> (q)))"},
+      {"([] not (not (p) until (q))) or ([] not (f))", "true"},
+    });
+  }
+  else if (TEST == "verdict") {
+    auto verdict = [](const std::string& outputs) {
+      std::size_t separator = outputs.find('\n');
+      return verdict_name(LTL2PROP::static_verdict(outputs.substr(0, separator),
+                                                   separator == std::string::npos ? "" : outputs.substr(separator + 1)));
+    };
+    // the property, then its propositions
+    passed = check(TEST, verdict, {
+      {"ltl property reentrancy: true;", "holds"},
+      {"ltl property called: false;", "violated"},
+      {"ltl property uncalled: [] not ( funcallp ); \nproposition funcallp : p'card > 0;", "undecided"},
+      {"ltl property usv: not (readp) until (write);\nproposition readp : p'card > 0;\nproposition write: false;",
+       "violated"},
+      {"ltl property sequentialcall: [] ( ( funcallA ) => <> ( funcallBp ) );\n"
+       "proposition funcallA : false;\nproposition funcallBp : p'card > 0;",
+       "holds"},
+      {"ltl property x: [] a;\nproposition a: (true);", "holds"},
+      // a property that cannot be parsed is left to Helena
+      {"property sequentialcall: [] ( ( funcallA ) => <> ( funcallB ) );\nproposition funcallA : false;",
+       "undecided"},
+      {"ltl property x: (a or;\nproposition a: true;", "undecided"},
+      {"ltl property x: a b;\nproposition a: true;", "undecided"},
+      {"", "undecided"},
+    });
+  }
+  else {
+    std::cerr << "Unknown test " << TEST << std::endl;
+    return 2;
+  }
+
+  if (passed) std::cout << TEST << ": passed" << std::endl;
+  return passed ? 0 : 1;
+}
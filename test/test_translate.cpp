@@ -0,0 +1,453 @@
+#include "IncrementalIndex.hpp"
+#include "LTLtranslator.hpp"
+#include "Net.hpp"
+#include "NetLoader.hpp"
+#include <CLI11.hpp>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <json.hpp>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Build a statement of the test net
+ *
+ * @return JSON object of the statement
+ */
+nlohmann::json statement(const std::string& type, const std::string& smart_contract, const std::string& parent,
+                         const std::string& variable, const std::string& function, const std::string& place,
+                         const std::vector<std::string>& RHV = {}) {
+  return {
+    {"type", type},
+    {"smart_contract", smart_contract},
+    {"parent", parent},
+    {"variable", variable},
+    {"function", function},
+    {"input_place", place + "_in"},
+    {"output_place", place + "_out"},
+    {"param_place", type == "function_call" ? place + "_par" : ""},
+    {"right_hand_variables", RHV},
+    {"timestamp", false},
+  };
+}
+
+/**
+ * Build the lna-info of each smart contract of the test net
+ *
+ * Transactions start in Proxy.main, which calls Bank.run and Rival.attack;
+ * Bank.run calls Bank.withdraw, which tests the balance, and Rival.attack
+ * calls selfdestruct. Rival.unused also calls selfdestruct, and drain, but no
+ * entry point reaches it. The calls of Proxy are only found in a load of the whole
+ * net, no formula references Proxy.
+ *
+ * @return lna-info of each smart contract, the entry points are in Proxy's
+ */
+std::map<std::string, nlohmann::json> contract_infos() {
+  auto contract_info = [](const std::vector<nlohmann::json>& statements) {
+    return nlohmann::json{{"global_variables", nlohmann::json::array()},
+                          {"functions", nlohmann::json::array()},
+                          {"statements", statements}};
+  };
+
+  std::map<std::string, nlohmann::json> infos;
+  infos["Bank"] = contract_info({
+    statement("variable_declaration", "Bank", "withdraw", "amount", "withdraw", "Bank_withdraw_decl",
+              {"address(this).balance"}),
+    statement("selection", "Bank", "withdraw", "amount", "withdraw", "Bank_withdraw_sel"),
+    statement("sending", "Bank", "withdraw", "", "withdraw", "Bank_withdraw_send", {"amount"}),
+    statement("assignment", "Bank", "withdraw", "total", "withdraw", "Bank_withdraw_asg", {"amount"}),
+    statement("function_call", "Bank", "withdraw", "", "log", "Bank_withdraw_log"),
+    statement("function_call", "Bank", "run", "", "withdraw", "Bank_run_withdraw"),
+  });
+  infos["Bank"]["global_variables"] = {{{"name", "total"}}};
+  infos["Bank"]["functions"] = {{{"name", "withdraw"},
+                                 {"smart_contract", "Bank"},
+                                 {"local_variables", {{{"name", "amount"}, {"place", "Bank_withdraw_locals"}}}}}};
+  infos["Rival"] = contract_info({
+    statement("function_call", "Rival", "attack", "", "selfdestruct", "Rival_attack_selfdestruct"),
+    statement("function_call", "Rival", "unused", "", "selfdestruct", "Rival_unused_selfdestruct"),
+    statement("function_call", "Rival", "unused", "", "drain", "Rival_unused_drain"),
+  });
+  infos["Proxy"] = contract_info({
+    statement("function_call", "Proxy", "main", "", "run", "Proxy_main_run"),
+    statement("function_call", "Proxy", "main", "", "attack", "Proxy_main_attack"),
+    statement("assignment", "Proxy", "main", "total", "main", "Proxy_main_asg", {"total"}),
+  });
+  infos["Proxy"]["global_variables"] = {{{"name", "owner"}}};
+  infos["Proxy"]["entry_points"] = {"main"};
+  return infos;
+}
+
+/**
+ * Merge the lna-info of the smart contracts into a single bundle
+ *
+ * @param infos lna-info of each smart contract
+ * @return lna-info of the whole net
+ */
+nlohmann::json bundle(const std::map<std::string, nlohmann::json>& infos) {
+  nlohmann::json lna_json = {{"global_variables", nlohmann::json::array()},
+                             {"functions", nlohmann::json::array()},
+                             {"statements", nlohmann::json::array()},
+                             {"entry_points", nlohmann::json::array()}};
+  for (const auto& info : infos) {
+    for (const char* key : {"global_variables", "functions", "statements", "entry_points"}) {
+      for (const auto& element : info.second.value(key, nlohmann::json::array())) {
+        lna_json[key].push_back(element);
+      }
+    }
+  }
+  return lna_json;
+}
+
+/**
+ * Build the formulas compared between the loads, with their translation
+ *
+ * The translations are checked by hand; a load of the whole net must give
+ * them. The call of drain by Rival.unused is never reached, so drain is never
+ * called.
+ *
+ * @return LTL formulas with their property and propositions
+ */
+std::vector<std::pair<nlohmann::json, std::map<std::string, std::string>>> test_formulas() {
+  auto formula = [](const std::string& type, const std::string& name, const nlohmann::json& inputs,
+                    const std::string& property, const std::string& propositions) {
+    return std::make_pair(nlohmann::json{{"type", type}, {"params", {{"name", name}, {"inputs", inputs}}}},
+                          std::map<std::string, std::string>{{"property", property}, {"propositions", propositions}});
+  };
+  return {
+    formula("general", "Self Destruction",
+            {{"selected_function", "withdraw"}, {"smart_contract", "Bank"}, {"rival_contract", "Rival"}},
+            "ltl property selfdestruction: (not  testonbalanceBank_withdraw_sel_out ) or ( not ( selfdestructRival_attack_selfdestruct_out ) until ( startBank_run_withdraw_in )); ",
+            "proposition testonbalanceBank_withdraw_sel_out : Bank_withdraw_sel_out'card > 0;\n"
+            "proposition selfdestructRival_attack_selfdestruct_out : Rival_attack_selfdestruct_out'card > 0;\n"
+            "proposition startBank_run_withdraw_in : Bank_run_withdraw_in'card > 0;\n"),
+    formula("general", "Self Destruction",
+            {{"selected_function", "withdraw"}, {"smart_contract", "Bank"}, {"rival_contract", ""}},
+            "ltl property selfdestruction: not ( testonbalanceBank_withdraw_sel_out ); ",
+            "proposition testonbalanceBank_withdraw_sel_out : Bank_withdraw_sel_out'card > 0;\n"),
+    formula("general", "Skip Empty String Literal", {{"selected_function", "withdraw"}, {"smart_contract", "Bank"}},
+            "ltl property skipempty: [] not (emptyparamBank_withdraw_log_par);",
+            "proposition emptyparamBank_withdraw_log_par: exists (t in Bank_withdraw_log_par | ((t->1)'space > 0) and ((t->1)'last'card > 0));\n"),
+    formula("general", "Integer Overflow/Underflow",
+            {{"selected_variable", "total"}, {"min_threshold", "0"}, {"max_threshold", "100"}},
+            "ltl property outOfRange: [] ( not OUFlow ) ;",
+            "proposition OUFlow: exists (t in S | (t->1).total < 0 or (t->1).total > 100);"),
+    formula("specific", "Variable Always Less Than",
+            {{"selected_variable", "amount"}, {"rival_variable", ""}, {"max_threshold", "100"},
+             {"selected_function", "withdraw"}, {"smart_contract", "Bank"}},
+            "ltl property smaller: [] not more;",
+            "proposition more: exists (t in Bank_withdraw_locals | (t->1).amount > 100);"),
+    formula("general", "Reentrancy",
+            {{"selected_variable", ""}, {"selected_function", "run"}, {"smart_contract", "Bank"}},
+            "ltl property reentrancy: ([] not (not (assignmentBank_withdraw_asg_out or assignmentBank_withdraw_decl_out) until (sendingBank_withdraw_send_out))) or ( [] not (sendingBank_withdraw_send_out));",
+            "proposition assignmentBank_withdraw_asg_out : (Bank_withdraw_asg_out'card > 0);\n"
+            "proposition assignmentBank_withdraw_decl_out : (Bank_withdraw_decl_out'card > 0);\n"
+            "proposition sendingBank_withdraw_send_out : (Bank_withdraw_send_out'card > 0);\n"
+            "proposition sendingBank_withdraw_send_out : (Bank_withdraw_send_out'card > 0);\n"),
+    formula("specific", "Function Is Eventually Called", {{"selected_function", "withdraw"}, {"smart_contract", "Bank"}},
+            "ltl property called: <> ( funcallBank_run_withdraw_in ); ",
+            "proposition funcallBank_run_withdraw_in : Bank_run_withdraw_in'card > 0;\n"),
+    formula("specific", "Function Is Eventually Called", {{"selected_function", "drain"}, {"smart_contract", "Rival"}},
+            "ltl property called: false;",
+            ""),
+    formula("specific", "Function Is Executed", {{"selected_function", "selfdestruct"}, {"smart_contract", "Rival"}},
+            "ltl property ifcalledthenexecuted: [] ( ( funcallRival_attack_selfdestruct_in ) => <> ( funexecRival_attack_selfdestruct_out ) );",
+            "proposition funcallRival_attack_selfdestruct_in : Rival_attack_selfdestruct_in'card > 0;\n"
+            "proposition funexecRival_attack_selfdestruct_out : Rival_attack_selfdestruct_out'card > 0;\n"),
+    formula("specific", "Sequential Call",
+            {{"selected_function", "withdraw"}, {"smart_contract", "Bank"},
+             {"rival_function", "selfdestruct"}, {"rival_contract", "Rival"}},
+            "ltl property sequentialcall: [] ( ( funcallABank_run_withdraw_in ) => <> ( funcallBRival_attack_selfdestruct_in ) );",
+            "proposition funcallABank_run_withdraw_in : Bank_run_withdraw_in'card > 0;\n"
+            "proposition funcallBRival_attack_selfdestruct_in : Rival_attack_selfdestruct_in'card > 0;\n"),
+  };
+}
+
+/**
+ * Translate a formula, an error is returned as its output
+ *
+ * @param net the net
+ * @param formula LTL formula
+ * @return property and propositions, or the error
+ */
+std::map<std::string, std::string> translate(const LTL2PROP::Net& net, const nlohmann::json& formula) {
+  try {
+    return LTL2PROP::LTLTranslator(net, formula).translate();
+  }
+  catch (const std::exception& e) {
+    return {{"error", e.what()}};
+  }
+}
+
+/**
+ * Check the places the variables of the comparison templates resolve to
+ *
+ * Bank.withdraw declares a local total shadowing the global total, and both
+ * Bank.withdraw and Rival.attack declare a local amount.
+ *
+ * @return true if every variable resolves to its expected place or error
+ */
+bool test_variables() {
+  nlohmann::json lna_json = {
+    {"global_variables", {{{"name", "total"}}}},
+    {"functions", {{{"name", "withdraw"}, {"smart_contract", "Bank"},
+                    {"local_variables", {{{"name", "total"}, {"place", "Bank_withdraw_locals"}},
+                                         {{"name", "amount"}, {"place", "Bank_withdraw_locals"}}}}},
+                   {{"name", "attack"}, {"smart_contract", "Rival"},
+                    {"local_variables", {{{"name", "amount"}, {"place", "Rival_attack_locals"}}}}}}},
+    {"statements", nlohmann::json::array()},
+  };
+  LTL2PROP::Net net = LTL2PROP::parse_net(lna_json.dump());
+
+  // variable, function and smart contract, with the expected place, empty for an error
+  const std::vector<std::vector<std::string>> cases = {
+    {"total", "withdraw", "Bank", "Bank_withdraw_locals"},  // shadowed global
+    {"total", "", "", "S"},
+    {"total", "attack", "Rival", "S"},
+    {"amount", "attack", "Rival", "Rival_attack_locals"},
+    {"amount", "", "", ""},  // ambiguous without its function
+    {"missing", "withdraw", "Bank", ""},
+    {"missing", "", "", ""},
+  };
+  bool passed = true;
+  for (const auto& test_case : cases) {
+    nlohmann::json formula = {{"type", "specific"},
+                              {"params", {{"name", "Variable Always Less Than"},
+                                          {"inputs", {{"selected_variable", test_case[0]}, {"rival_variable", ""},
+                                                      {"max_threshold", "100"}, {"selected_function", test_case[1]},
+                                                      {"smart_contract", test_case[2]}}}}}};
+    std::map<std::string, std::string> outputs = translate(net, formula);
+    std::string expected = test_case[3].empty()
+                               ? ""
+                               : "proposition more: exists (t in " + test_case[3] + " | (t->1)." + test_case[0] + " > 100);";
+    if (expected.empty() ? outputs.count("error") == 0 : outputs["propositions"] != expected) {
+      std::cout << "variables: FAILED, " << test_case[0] << " in " << test_case[2] << "." << test_case[1]
+                << ": got " << nlohmann::json(outputs).dump() << std::endl;
+      passed = false;
+    }
+  }
+  if (passed) std::cout << "variables: passed" << std::endl;
+  return passed;
+}
+
+/**
+ * Check that both backends reject the elements of an lna-info lacking a field
+ *
+ * @return true if every truncated lna-info is rejected by both backends
+ */
+bool test_missing_fields() {
+  const nlohmann::json lna_json = bundle(contract_infos());
+  // list of the truncated element, its field removed
+  const std::vector<std::pair<std::string, std::string>> cases = {
+    {"statements", "output_place"},
+    {"statements", "right_hand_variables"},
+    {"statements", "timestamp"},
+    {"global_variables", "name"},
+    {"functions", "smart_contract"},
+    {"functions", "name"},
+  };
+  bool passed = true;
+  for (const auto& test_case : cases) {
+    nlohmann::json truncated = lna_json;
+    truncated[test_case.first][0].erase(test_case.second);
+    for (LTL2PROP::JsonBackend backend : {LTL2PROP::JsonBackend::Dom, LTL2PROP::JsonBackend::Sax}) {
+      try {
+        LTL2PROP::parse_net(truncated.dump(), LTL2PROP::NetScope(), backend);
+        std::cout << "missing_fields: FAILED, the " << LTL2PROP::json_backend_name(backend) << " backend accepts "
+                  << test_case.first << " without " << test_case.second << std::endl;
+        passed = false;
+      }
+      catch (const std::exception&) {
+      }
+    }
+  }
+
+  // a local variable without its place
+  nlohmann::json truncated = lna_json;
+  truncated["functions"][0]["local_variables"][0].erase("place");
+  for (LTL2PROP::JsonBackend backend : {LTL2PROP::JsonBackend::Dom, LTL2PROP::JsonBackend::Sax}) {
+    try {
+      LTL2PROP::parse_net(truncated.dump(), LTL2PROP::NetScope(), backend);
+      std::cout << "missing_fields: FAILED, the " << LTL2PROP::json_backend_name(backend)
+                << " backend accepts a local variable without place" << std::endl;
+      passed = false;
+    }
+    catch (const std::exception&) {
+    }
+  }
+  if (passed) std::cout << "missing_fields: passed" << std::endl;
+  return passed;
+}
+
+/**
+ * Check that the index only keeps a Reentrancy property while its callees
+ * are unchanged
+ *
+ * Bank.withdraw calls log, which no smart contract defines until Rival.log
+ * sends; the property must then follow Rival.log. A statement added to
+ * Proxy.main, outside of the callees, keeps the property up to date.
+ *
+ * @return true if the index checks give the expected verdicts
+ */
+bool test_incremental() {
+  const nlohmann::json lna_json = bundle(contract_infos());
+  const nlohmann::json formula = {{"type", "general"},
+                                  {"params", {{"name", "Reentrancy"},
+                                              {"inputs", {{"selected_variable", ""}, {"selected_function", "withdraw"},
+                                                          {"smart_contract", "Bank"}}}}}};
+  const std::string formula_hash = LTL2PROP::content_hash(formula.dump());
+
+  LTL2PROP::Net net = LTL2PROP::parse_net(lna_json.dump());
+  LTL2PROP::LTLTranslator translator(net, formula);
+  std::map<std::string, std::string> outputs = translator.translate();
+  LTL2PROP::IncrementalIndex index("");
+  index.update("reentrancy", formula_hash, translator.get_dependencies(), LTL2PROP::net_digests(net),
+               outputs["propositions"], {});
+
+  // changed nets, with whether the property is still up to date
+  auto changed_net = [&lna_json](const nlohmann::json& added) {
+    nlohmann::json changed = lna_json;
+    changed["statements"].push_back(added);
+    return LTL2PROP::parse_net(changed.dump());
+  };
+  const std::vector<std::pair<std::string, std::pair<LTL2PROP::Net, bool>>> cases = {
+    {"a callee defined by Rival.log",
+     {changed_net(statement("sending", "Rival", "log", "", "log", "Rival_log_send")), false}},
+    {"a statement of Proxy.main",
+     {changed_net(statement("assignment", "Proxy", "main", "owner", "main", "Proxy_main_owner")), true}},
+  };
+  bool passed = true;
+  for (const auto& test_case : cases) {
+    const LTL2PROP::Net& changed = test_case.second.first;
+    bool up_to_date = index.is_up_to_date("reentrancy", formula_hash, LTL2PROP::net_digests(changed), {});
+    bool same_outputs = translate(changed, formula) == outputs;
+    if (up_to_date != test_case.second.second || (up_to_date && !same_outputs)) {
+      std::cout << "incremental: FAILED, with " << test_case.first << " the property is "
+                << (up_to_date ? "up to date" : "outdated") << " and its outputs are "
+                << (same_outputs ? "the same" : "changed") << std::endl;
+      passed = false;
+    }
+  }
+  if (passed) std::cout << "incremental: passed" << std::endl;
+  return passed;
+}
+
+/**
+ * Write a JSON file
+ *
+ * @param filename path to the file
+ * @param content JSON content
+ */
+void write_json(const std::string& filename, const nlohmann::json& content) {
+  std::ofstream file_stream(filename);
+  file_stream << content.dump(2) << std::endl;
+  if (!file_stream) throw std::runtime_error("Could not write " + filename);
+}
+
+int main(int argc, char **argv) {
+  CLI::App app{"LTLTranslator translation test"};
+
+  std::string TEST;
+  app.add_option("--test", TEST,
+                 "Loads to be compared with the load of the whole net: "
+                 "selective_load or selective_shards; or variables, missing_fields, incremental")
+      ->required();
+
+  std::string WORK_DIR;
+  app.add_option("--work-dir", WORK_DIR, "Directory of the files written by the test")
+      ->default_val(".")
+      ->check(CLI::ExistingDirectory);
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (TEST == "variables") return test_variables() ? 0 : 1;
+  if (TEST == "missing_fields") return test_missing_fields() ? 0 : 1;
+  if (TEST == "incremental") return test_incremental() ? 0 : 1;
+
+  std::map<std::string, nlohmann::json> infos = contract_infos();
+  std::string lna_info = bundle(infos).dump();
+
+  // load of the net through the lna-info of the test, with a scope
+  std::function<LTL2PROP::Net(const LTL2PROP::NetScope&, LTL2PROP::JsonBackend)> load;
+  if (TEST == "selective_load") {
+    load = [&](const LTL2PROP::NetScope& scope, LTL2PROP::JsonBackend backend) {
+      return LTL2PROP::parse_net(lna_info, scope, backend);
+    };
+  }
+  else if (TEST == "selective_shards") {
+    nlohmann::json manifest = {{"global_variables", nlohmann::json::array()},
+                               {"shards", nlohmann::json::array()}};
+    for (const auto& info : infos) {
+      std::string path = TEST + "." + info.first + ".json";
+      write_json(WORK_DIR + "/" + path, info.second);
+      manifest["shards"].push_back({{"smart_contract", info.first}, {"path", path}});
+    }
+    write_json(WORK_DIR + "/" + TEST + ".json", manifest);
+    load = [&](const LTL2PROP::NetScope& scope, LTL2PROP::JsonBackend backend) {
+      return LTL2PROP::load_net(WORK_DIR + "/" + TEST + ".json", scope, backend);
+    };
+  }
+  else {
+    std::cerr << "Unknown test " << TEST << std::endl;
+    return 2;
+  }
+
+  // every formula gets its known translation from a load of the whole bundle
+  LTL2PROP::Net whole_net = LTL2PROP::parse_net(lna_info);
+  bool passed = true;
+  for (const auto& test_formula : test_formulas()) {
+    const nlohmann::json& formula = test_formula.first;
+    const std::map<std::string, std::string>& expected = test_formula.second;
+    std::string name = formula.at("params").at("name");
+    std::map<std::string, std::string> whole_outputs = translate(whole_net, formula);
+    if (whole_outputs != expected) {
+      std::cout << TEST << ": FAILED, " << name << " with the load of the whole bundle:\n"
+                << "  expected " << nlohmann::json(expected).dump() << "\n"
+                << "  got      " << nlohmann::json(whole_outputs).dump() << std::endl;
+      passed = false;
+      continue;
+    }
+
+    for (LTL2PROP::JsonBackend backend : {LTL2PROP::JsonBackend::Dom, LTL2PROP::JsonBackend::Sax}) {
+      for (bool selective : {false, true}) {
+        LTL2PROP::NetScope scope = selective ? LTL2PROP::formula_scope(formula) : LTL2PROP::NetScope();
+        LTL2PROP::Net net = load(scope, backend);
+        std::map<std::string, std::string> outputs = translate(net, formula);
+
+        // a shard outside the scope only gives its call sites and entry points
+        bool proxy_variables = std::find(net.global_variables.begin(), net.global_variables.end(), "owner") !=
+                               net.global_variables.end();
+        if (TEST == "selective_shards" && selective && !scope.whole_net && !scope.all_functions &&
+            proxy_variables) {
+          std::cout << TEST << ": FAILED, " << name << " with the selective load of the "
+                    << LTL2PROP::json_backend_name(backend) << " backend reads the variables of Proxy"
+                    << std::endl;
+          passed = false;
+        }
+        if (outputs != expected) {
+          std::cout << TEST << ": FAILED, " << name << " with the "
+                    << (selective ? "selective" : "whole") << " load of the "
+                    << LTL2PROP::json_backend_name(backend) << " backend:\n"
+                    << "  expected " << nlohmann::json(expected).dump() << "\n"
+                    << "  got      " << nlohmann::json(outputs).dump() << std::endl;
+          passed = false;
+        }
+      }
+    }
+  }
+
+  // the call sites of Rival.attack are only reachable through Proxy.main
+  std::map<std::string, std::string> self_destruction = translate(whole_net, test_formulas().front().first);
+  if (self_destruction["propositions"].find("Rival_attack_selfdestruct_out") == std::string::npos ||
+      self_destruction["propositions"].find("Rival_unused_selfdestruct_out") != std::string::npos) {
+    std::cout << TEST << ": FAILED, Self Destruction does not follow the entry points: "
+              << self_destruction["property"] << std::endl;
+    passed = false;
+  }
+  if (passed) std::cout << TEST << ": passed" << std::endl;
+  return passed ? 0 : 1;
+}